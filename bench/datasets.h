@@ -0,0 +1,95 @@
+#ifndef BENCH_DATASETS_H
+#define BENCH_DATASETS_H
+
+#include <math.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+// Synthetic point sets resembling the inputs of voro3d, matching the
+// generators of bench/datasets.R. Coordinates are stored at every 3 elements.
+
+// Composites every `composite` metres along drill holes of `depth` metres.
+// Collars lie on a jittered grid with `spacing` metres between holes and the
+// holes dip between 55 and 90 degrees towards a random azimuth.
+inline std::vector< double > drillholes( int n, std::mt19937_64& rng,
+                                         double spacing = 50,
+                                         double composite = 1,
+                                         double depth = 100 )
+{
+  std::uniform_real_distribution< double > unit ( 0, 1 );
+  int perHole = std::max( 1, int( round( depth / composite ) ) );
+  int holes = ( n + perHole - 1 ) / perHole;
+  int side = int( ceil( sqrt( double( holes ) ) ) );
+  std::vector< double > points;
+  points.reserve( 3 * n );
+
+  for ( int h = 0; h < holes && int( points.size() ) < 3 * n; h++ )
+  {
+    double cx = ( h % side + 1 + 0.4 * unit( rng ) - 0.2 ) * spacing;
+    double cy = ( h / side + 1 + 0.4 * unit( rng ) - 0.2 ) * spacing;
+    double cz = 100 + 10 * sin( cx / 500 ) * cos( cy / 700 );
+    double azimuth = 2 * M_PI * unit( rng );
+    double dip = ( 55 + 35 * unit( rng ) ) * M_PI / 180;
+
+    for ( int s = 0; s < perHole && int( points.size() ) < 3 * n; s++ )
+    {
+      double along = ( s + 0.5 ) * composite;
+      points.push_back( cx + along * cos( dip ) * sin( azimuth ) );
+      points.push_back( cy + along * cos( dip ) * cos( azimuth ) );
+      points.push_back( cz - along * sin( dip ) );
+    }
+  }
+
+  return points;
+}
+
+// Centroids of a regular block model with 5 x 5 x 2.5 metre blocks
+inline std::vector< double > blockGrid( int n )
+{
+  int side = int( ceil( cbrt( double( n ) ) ) );
+  std::vector< double > points;
+  points.reserve( 3 * n );
+
+  for ( int b = 0; b < n; b++ )
+  {
+    points.push_back( ( b % side + 0.5 ) * 5 );
+    points.push_back( ( b / side % side + 0.5 ) * 5 );
+    points.push_back( ( b / ( side * side ) + 0.5 ) * 2.5 );
+  }
+
+  return points;
+}
+
+// Uniformly random points at a density of one point per 125 cubic metres in
+// a box twice as wide as it is deep
+inline std::vector< double > uniformBox( int n, std::mt19937_64& rng )
+{
+  double depth = cbrt( n * 125.0 / 4 );
+  std::uniform_real_distribution< double > unit ( 0, 1 );
+  std::vector< double > points;
+  points.reserve( 3 * n );
+
+  for ( int p = 0; p < n; p++ )
+  {
+    points.push_back( 2 * depth * unit( rng ) );
+    points.push_back( 2 * depth * unit( rng ) );
+    points.push_back( depth * unit( rng ) );
+  }
+
+  return points;
+}
+
+// Dataset by name: "drillholes", "blockGrid" or "uniformBox"
+inline std::vector< double > dataset( const std::string& name, int n,
+                                      std::mt19937_64& rng )
+{
+  if ( name == "drillholes" )
+    return drillholes( n, rng );
+  if ( name == "blockGrid" )
+    return blockGrid( n );
+  return uniformBox( n, rng );
+}
+
+#endif
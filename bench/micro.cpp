@@ -0,0 +1,117 @@
+// Microbenchmark of the phases of voronoi() without R.
+//
+//   ./micro [largest size] [threads]
+//
+// For each dataset and size from 1e3 up to the largest size (default 1e6) by
+// powers of ten, the cells are computed several times, each pass doing one
+// more phase than the one before. The time of a phase is the difference from
+// the previous pass:
+//
+//   put      container setup and insertion of the points
+//   compute  compute_cell() of every particle
+//   walk     face walk of each cell into a CellMesh
+//   wkt      well-known text of each cell (triangle fans, 6 decimals)
+//   wkb      well-known binary of each cell (triangle fans)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+#include <voro++.hh>
+
+#include "engine.h"
+#include "wkb.h"
+#include "wkt.h"
+#include "datasets.h"
+
+typedef std::chrono::steady_clock Clock;
+
+static double secondsSince( Clock::time_point start )
+{
+  return std::chrono::duration< double >( Clock::now() - start ).count();
+}
+
+// Output buffers of one thread, next to the scratch space of the engine
+struct Writer
+{
+  WktWriter wkt;
+  std::string text;
+  std::vector< unsigned char > binary;
+};
+
+// Run the phases up to and including `phase` (1: compute, 2: walk, 3: wkt,
+// 4: wkb) for every particle and return the elapsed seconds
+static double pass( voro::container& con, int threads, int phase )
+{
+  CellWorkers workers = cellWorkers( threads );
+  std::vector< Writer > writers ( threads );
+
+  Clock::time_point start = Clock::now();
+  computeCells( con, workers, [&]( CellWorker& worker, int,
+                                   const double* position, int thread )
+  {
+    Writer& w = writers[thread];
+    if ( phase < 2 )
+      return;
+
+    walkCell( worker.vc, position[0], position[1], position[2], worker.mesh );
+
+    if ( phase == 3 )
+      w.wkt.write( worker.mesh, false, w.text );
+
+    else if ( phase == 4 )
+      cellWkb( worker.mesh, false, worker.faces, w.binary );
+  } );
+
+  return secondsSince( start );
+}
+
+// Container of voronoi() with a container ratio of 1.1
+static std::unique_ptr< voro::container > containerOf( const std::vector< double >& p )
+{
+  size_t n = p.size() / 3;
+  std::vector< double > x ( n ), y ( n ), z ( n );
+  for ( size_t i = 0; i < n; i++ )
+  {
+    x[i] = p[3 * i];
+    y[i] = p[3 * i + 1];
+    z[i] = p[3 * i + 2];
+  }
+
+  return pointContainer( Points { x.data(), y.data(), z.data(), n }, 1.1 );
+}
+
+int main( int argc, char** argv )
+{
+  double largest = argc > 1 ? atof( argv[1] ) : 1e6;
+  int threads = argc > 2 ? atoi( argv[2] ) : 1;
+  const char* names[] = { "drillholes", "blockGrid", "uniformBox" };
+  std::mt19937_64 rng ( 20220411 );
+
+  printf( "dataset,n,threads,put,compute,walk,wkt,wkb\n" );
+  for ( double n = 1e3; n <= largest; n *= 10 )
+  {
+    for ( const char* name : names )
+    {
+      std::vector< double > points = dataset( name, int( n ), rng );
+
+      Clock::time_point start = Clock::now();
+      std::unique_ptr< voro::container > con = containerOf( points );
+      double put = secondsSince( start );
+
+      double compute = pass( *con, threads, 1 );
+      double walk = pass( *con, threads, 2 );
+      double wkt = pass( *con, threads, 3 );
+      double wkb = pass( *con, threads, 4 );
+
+      printf( "%s,%.0f,%d,%.4f,%.4f,%.4f,%.4f,%.4f\n", name, n, threads,
+              put, compute, walk - compute, wkt - walk, wkb - walk );
+      fflush( stdout );
+    }
+  }
+
+  return 0;
+}
@@ -0,0 +1,686 @@
+// Command-line interface to the voro3d engine, built on the C API.
+//
+//   voro3d-cli [options] <input> <output>
+//
+// The input is either a CSV file whose first three columns are the x, y and z
+// coordinates (a header line is skipped), or a binary file of native doubles
+// stored as x, y, z triples. With --radius, the radius of each point follows
+// its coordinates as a fourth column or value. The output is written in input order, one cell
+// per line, to a file or to standard output if <output> is "-".
+
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "voro3d.h"
+
+static void usage( FILE* out )
+{
+  fprintf( out,
+    "Usage: voro3d-cli [options] <input> <output>\n"
+    "\n"
+    "Options:\n"
+    "  -r, --ratio R        container ratio (default 1)\n"
+    "  -t, --threads N      number of threads (default 1)\n"
+    "  -f, --format F       wkt, geojson, csv, wkb, mesh, volume, adjacency or\n"
+    "                       blocks (default wkt)\n"
+    "  -p, --polygons       write faces as polygons instead of triangles\n"
+    "  -d, --precision D    decimals in wkt, negative for shortest (default 6)\n"
+    "  -i, --input I        csv or bin (default: csv for *.csv, else bin)\n"
+    "  -w, --radius         read the radius of each point after its coordinates\n"
+    "                       and compute the power (Laguerre) diagram\n"
+    "  -g, --grid G         uniform, tuned or anisotropic (default uniform)\n"
+    "      --blocks X,Y,Z   number of blocks of the container along each axis\n"
+    "      --init-mem N     initial number of points per block\n"
+    "      --plane A,B,C,D  keep the half-space A x + B y + C z <= D\n"
+    "      --prism Z0,Z1,X1,Y1,X2,Y2,...\n"
+    "                       keep the convex prism of the polygon (X, Y)\n"
+    "                       between the elevations Z0 and Z1\n"
+    "      --cylinder X,Y,Z,DX,DY,DZ,R\n"
+    "                       keep the inside of the cylinder of radius R around\n"
+    "                       the axis through (X, Y, Z) along (DX, DY, DZ)\n"
+    "  The wall options can be repeated, except --prism.\n"
+    "      --max-radius R   clip each cell by the sphere of radius R around its\n"
+    "                       point, or by an ellipsoid if R is RMAJOR,RSEMI,RMINOR\n"
+    "      --max-radius-angles STRIKE,DIP,PLUNGE\n"
+    "                       rotation of the ellipsoid in degrees\n"
+    "      --anisotropy RMAJOR,RSEMI,RMINOR\n"
+    "                       compute the cells where the ellipsoid of these\n"
+    "                       ranges is a sphere and map them back\n"
+    "      --anisotropy-angles STRIKE,DIP,PLUNGE\n"
+    "                       rotation of the anisotropy in degrees\n"
+    "      --dem FILE       clip the cells by the terrain of an ESRI ASCII grid,\n"
+    "                       keeping their part below it\n"
+    "      --block-model X0,Y0,Z0,DX,DY,DZ,NX,NY,NZ\n"
+    "                       blocks of DX by DY by DZ from the corner (X0, Y0, Z0)\n"
+    "                       by which the cells are split for --format blocks\n"
+    "      --locate FILE    instead of the cells, find the cell of each point of\n"
+    "                       FILE, read like the input\n"
+    "      --tiles X,Y,Z    compute the cells tile by tile from a binary input,\n"
+    "                       which is mapped instead of read into memory\n"
+    "      --halo H         width of the halo of points around each tile\n"
+    "                       (default twice the mean spacing of the points)\n"
+    "\n"
+    "wkt and wkb (as hex) are written one cell per line; cells that could not\n"
+    "be computed are written as empty surfaces. wkt, geojson and csv are\n"
+    "written as the cells are computed, without keeping them in memory:\n"
+    "geojson is a GeoJSON text sequence of one Feature per point, with the\n"
+    "1-based point number as id and the volume as property, and csv writes\n"
+    "the lines id,wkt,volume (NA,NA if not computed) after a header. volume writes one number per\n"
+    "line (NA if not computed) and mesh writes a Wavefront OBJ file with one\n"
+    "object per cell. adjacency writes the CSV lines cell,neighbour,area with\n"
+    "1-based point numbers, and negative neighbours for the container (-1 to\n"
+    "-6) and the walls. blocks writes the CSV lines cell,block,volume with\n"
+    "1-based block numbers, x first, then y, then z. --locate writes the CSV lines index,distance of the\n"
+    "1-based point nearest to each query and the distance to it (NA,NA for\n"
+    "queries with missing coordinates). --tiles writes geojson or csv records\n"
+    "tile by tile, and only for points with coordinates.\n" );
+}
+
+static void die( const char* message, const char* detail = "" )
+{
+  fprintf( stderr, "voro3d-cli: %s%s\n", message, detail );
+  exit( 1 );
+}
+
+// Append the comma separated numbers of `text` to `values`
+static size_t parseNumbers( const char* text, std::vector< double >& values )
+{
+  size_t count = 0;
+  char* end;
+
+  while ( true )
+  {
+    double value = strtod( text, &end );
+    if ( end == text )
+      die( "expected comma separated numbers: ", text );
+
+    values.push_back( value );
+    count++;
+    if ( *end != ',' )
+      break;
+    text = end + 1;
+  }
+
+  if ( *end != '\0' )
+    die( "expected comma separated numbers: ", end );
+
+  return count;
+}
+
+// Read the first columns of a CSV file, one into each vector of `values`
+static void readCsv( FILE* in, std::vector< std::vector< double > >& values )
+{
+  char line[4096];
+  long number = 0;
+  int columns = values.size();
+
+  while ( fgets( line, sizeof( line ), in ) )
+  {
+    double value[4];
+    char* field = line;
+    char* end;
+    int column;
+    number++;
+
+    for ( column = 0; column < columns; column++ )
+    {
+      value[column] = strtod( field, &end );
+      if ( end == field )
+        break;
+      field = end;
+      while ( *field == ' ' || *field == '\t' )
+        field++;
+      if ( column < columns - 1 && *field++ != ',' )
+      {
+        column++;
+        break;
+      }
+    }
+
+    if ( column < columns )
+    {
+      // Skip the header and blank lines
+      if ( number == 1 || strspn( line, " \t\r\n" ) == strlen( line ) )
+        continue;
+      fprintf( stderr, "voro3d-cli: line %ld: ", number );
+      die( columns == 3 ? "expected three numeric columns"
+                        : "expected four numeric columns" );
+    }
+
+    for ( column = 0; column < columns; column++ )
+      values[column].push_back( value[column] );
+  }
+}
+
+// Read tuples of native doubles, one into each vector of `values`
+static void readBinary( FILE* in, std::vector< std::vector< double > >& values )
+{
+  double point[4];
+  size_t columns = values.size(), count;
+
+  while ( ( count = fread( point, sizeof( double ), columns, in ) ) == columns )
+  {
+    for ( size_t column = 0; column < columns; column++ )
+      values[column].push_back( point[column] );
+  }
+
+  if ( count != 0 )
+    die( columns == 3 ? "binary input is not a whole number of x, y, z triples"
+                      : "binary input is not a whole number of x, y, z, radius tuples" );
+}
+
+// Read an ESRI ASCII grid into the terrain of `options`. The rows of the file
+// run from north to south and each value is the elevation at the center of
+// its grid cell, which becomes a node of the terrain.
+static void readDem( const char* file, voro3d_options& options,
+                     std::vector< double >& elevations )
+{
+  FILE* in = fopen( file, "r" );
+  if ( !in )
+    die( "cannot open dem: ", strerror( errno ) );
+
+  int columns = 0, rows = 0;
+  double x = 0, y = 0, size = 0, noData = NAN;
+  bool corner = true;
+  char key[64];
+  long position = ftell( in );
+
+  while ( fscanf( in, "%63s", key ) == 1 && isalpha( (unsigned char) key[0] ) )
+  {
+    for ( char* c = key; *c; c++ )
+      *c = tolower( (unsigned char) *c );
+
+    double value;
+    if ( fscanf( in, "%lf", &value ) != 1 )
+      die( "invalid dem header at ", key );
+
+    if ( strcmp( key, "ncols" ) == 0 )
+      columns = int( value );
+    else if ( strcmp( key, "nrows" ) == 0 )
+      rows = int( value );
+    else if ( strcmp( key, "xllcorner" ) == 0 || strcmp( key, "xllcenter" ) == 0 )
+    {
+      x = value;
+      corner = strcmp( key, "xllcorner" ) == 0;
+    }
+    else if ( strcmp( key, "yllcorner" ) == 0 || strcmp( key, "yllcenter" ) == 0 )
+      y = value;
+    else if ( strcmp( key, "cellsize" ) == 0 )
+      size = value;
+    else if ( strcmp( key, "nodata_value" ) == 0 )
+      noData = value;
+    else
+      die( "unknown dem header ", key );
+
+    position = ftell( in );
+  }
+
+  if ( columns < 2 || rows < 2 || !( size > 0 ) )
+    die( "dem must have ncols, nrows of at least 2 and a positive cellsize" );
+
+  // Go back to the first value, read as a key by the loop
+  fseek( in, position, SEEK_SET );
+
+  elevations.assign( size_t( columns ) * rows, 0 );
+  for ( int row = rows - 1; row >= 0; row-- )
+  {
+    for ( int column = 0; column < columns; column++ )
+    {
+      double& value = elevations[column + size_t( columns ) * row];
+      if ( fscanf( in, "%lf", &value ) != 1 )
+        die( "dem has fewer values than ncols times nrows" );
+      if ( value == noData )
+        value = NAN;
+    }
+  }
+  fclose( in );
+
+  double offset = corner ? size / 2 : 0;
+  options.dem_z = elevations.data();
+  options.dem_nx = columns;
+  options.dem_ny = rows;
+  options.dem_x0 = x + offset;
+  options.dem_y0 = y + offset;
+  options.dem_dx = options.dem_dy = size;
+}
+
+// Hex of `length` bytes from `binary`
+static void writeHex( FILE* out, const unsigned char* binary, size_t length )
+{
+  static const char* hex = "0123456789ABCDEF";
+  for ( size_t b = 0; b < length; b++ )
+  {
+    fputc( hex[binary[b] >> 4], out );
+    fputc( hex[binary[b] & 15], out );
+  }
+}
+
+// Well-known binary of an empty polyhedral surface of the same type (1015,
+// with Z) and byte order (that of the machine) as voro3d_wkb()
+static void writeEmptyWkb( FILE* out )
+{
+  unsigned char empty[9];
+  uint32_t type = 1015, count = 0;
+  uint16_t order = 1;
+  memcpy( empty, &order, 1 );
+  memcpy( empty + 1, &type, 4 );
+  memcpy( empty + 5, &count, 4 );
+  writeHex( out, empty, sizeof( empty ) );
+}
+
+static void writeOutput( FILE* out, const voro3d_result* result, int format )
+{
+  size_t cells = voro3d_cells( result ), length;
+  long vertexBase = 1;
+
+  for ( size_t id = 0; id < cells; id++ )
+  {
+    if ( format == VORO3D_WKB )
+    {
+      const unsigned char* binary = voro3d_wkb( result, id, &length );
+      if ( binary )
+        writeHex( out, binary, length );
+      else
+        writeEmptyWkb( out );
+      fputc( '\n', out );
+    }
+
+    else if ( format == VORO3D_ADJACENCY )
+    {
+      const int* neighbours;
+      const double* areas;
+      int faceCount;
+
+      if ( id == 0 )
+        fputs( "cell,neighbour,area\n", out );
+      if ( !voro3d_adjacency( result, id, &neighbours, &areas, &faceCount ) )
+        continue;
+
+      for ( int f = 0; f < faceCount; f++ )
+      {
+        int neighbour = neighbours[f] >= 0 ? neighbours[f] + 1 : neighbours[f];
+        fprintf( out, "%zu,%d,%.17g\n", id + 1, neighbour, areas[f] );
+      }
+    }
+
+    else if ( format == VORO3D_BLOCKS )
+    {
+      const int* blocks;
+      const double* volumes;
+      int blockCount;
+
+      if ( id == 0 )
+        fputs( "cell,block,volume\n", out );
+      if ( !voro3d_blocks( result, id, &blocks, &volumes, &blockCount ) )
+        continue;
+
+      for ( int b = 0; b < blockCount; b++ )
+        fprintf( out, "%zu,%d,%.17g\n", id + 1, blocks[b] + 1, volumes[b] );
+    }
+
+    else if ( format == VORO3D_VOLUME )
+    {
+      if ( voro3d_computed( result, id ) )
+        fprintf( out, "%.17g\n", voro3d_volume( result, id ) );
+      else
+        fputs( "NA\n", out );
+    }
+
+    else
+    {
+      const double* vertices;
+      const int *faces, *faceSizes;
+      int vertexCount, faceCount;
+
+      if ( !voro3d_mesh( result, id, &vertices, &vertexCount,
+                         &faces, &faceSizes, &faceCount ) )
+        continue;
+
+      fprintf( out, "o cell%zu\n", id + 1 );
+      for ( int v = 0; v < vertexCount; v++ )
+      {
+        fprintf( out, "v %.17g %.17g %.17g\n", vertices[3 * v],
+                 vertices[3 * v + 1], vertices[3 * v + 2] );
+      }
+
+      for ( int f = 0; f < faceCount; f++ )
+      {
+        fputc( 'f', out );
+        for ( int i = 0; i < faceSizes[f]; i++ )
+          fprintf( out, " %ld", vertexBase + *faces++ );
+        fputc( '\n', out );
+      }
+      vertexBase += vertexCount;
+    }
+  }
+}
+
+// Read the columns of the file `name`, a CSV file if `input` is "csv" or if
+// it is empty and the name ends in .csv, and a binary file otherwise
+static void readInput( const char* name, const std::string& input,
+                       std::vector< std::vector< double > >& values )
+{
+  size_t length = strlen( name );
+  bool csv = input.empty() ? length > 4 && strcmp( name + length - 4, ".csv" ) == 0
+                           : input == "csv";
+
+  FILE* in = fopen( name, csv ? "r" : "rb" );
+  if ( !in )
+    die( "cannot open input: ", strerror( errno ) );
+
+  if ( csv )
+    readCsv( in, values );
+  else
+    readBinary( in, values );
+  fclose( in );
+}
+
+int main( int argc, char** argv )
+{
+  voro3d_options options;
+  std::vector< const char* > files;
+  std::vector< double > planes, cylinders, prismX, prismY, elevations;
+  std::string input;
+  const char* queryFile = NULL;
+  int stream = VORO3D_STREAM_WKT;
+  int tiles[3] = { 0, 0, 0 };
+  double halo = 0;
+  bool weighted = false;
+
+  voro3d_default_options( &options );
+
+  for ( int a = 1; a < argc; a++ )
+  {
+    std::string arg = argv[a];
+    bool hasValue = a + 1 < argc;
+
+    if ( arg == "-h" || arg == "--help" )
+    {
+      usage( stdout );
+      return 0;
+    }
+
+    else if ( ( arg == "-r" || arg == "--ratio" ) && hasValue )
+      options.container_ratio = atof( argv[++a] );
+
+    else if ( ( arg == "-t" || arg == "--threads" ) && hasValue )
+      options.threads = atoi( argv[++a] );
+
+    else if ( ( arg == "-d" || arg == "--precision" ) && hasValue )
+      options.precision = atoi( argv[++a] );
+
+    else if ( arg == "-p" || arg == "--polygons" )
+      options.polygons = 1;
+
+    else if ( arg == "-w" || arg == "--radius" )
+      weighted = true;
+
+    else if ( ( arg == "-i" || arg == "--input" ) && hasValue )
+      input = argv[++a];
+
+    else if ( ( arg == "-g" || arg == "--grid" ) && hasValue )
+    {
+      std::string grid = argv[++a];
+      if ( grid == "uniform" )
+        options.grid = VORO3D_GRID_UNIFORM;
+      else if ( grid == "tuned" )
+        options.grid = VORO3D_GRID_TUNED;
+      else if ( grid == "anisotropic" )
+        options.grid = VORO3D_GRID_ANISOTROPIC;
+      else
+        die( "unknown grid ", grid.c_str() );
+    }
+
+    else if ( arg == "--blocks" && hasValue )
+    {
+      int* blocks = options.blocks;
+      if ( sscanf( argv[++a], "%d,%d,%d", blocks, blocks + 1, blocks + 2 ) != 3 )
+        die( "expected three comma separated numbers of blocks" );
+    }
+
+    else if ( arg == "--init-mem" && hasValue )
+      options.init_mem = atoi( argv[++a] );
+
+    else if ( arg == "--plane" && hasValue )
+    {
+      if ( parseNumbers( argv[++a], planes ) != 4 )
+        die( "expected 4 numbers for --plane" );
+    }
+
+    else if ( arg == "--cylinder" && hasValue )
+    {
+      if ( parseNumbers( argv[++a], cylinders ) != 7 )
+        die( "expected 7 numbers for --cylinder" );
+    }
+
+    else if ( arg == "--prism" && hasValue )
+    {
+      std::vector< double > values;
+      size_t count = parseNumbers( argv[++a], values );
+      if ( count < 8 || count % 2 != 0 )
+        die( "expected two elevations and at least 3 vertices for --prism" );
+
+      options.prism_z[0] = values[0];
+      options.prism_z[1] = values[1];
+      prismX.clear();
+      prismY.clear();
+      for ( size_t i = 2; i < count; i += 2 )
+      {
+        prismX.push_back( values[i] );
+        prismY.push_back( values[i + 1] );
+      }
+    }
+
+    else if ( arg == "--max-radius" && hasValue )
+    {
+      std::vector< double > ranges;
+      size_t count = parseNumbers( argv[++a], ranges );
+      if ( count != 1 && count != 3 )
+        die( "expected a radius or three ranges for --max-radius" );
+      for ( int axis = 0; axis < 3; axis++ )
+        options.max_radius[axis] = ranges[count == 1 ? 0 : axis];
+    }
+
+    else if ( arg == "--max-radius-angles" && hasValue )
+    {
+      std::vector< double > angles;
+      if ( parseNumbers( argv[++a], angles ) != 3 )
+        die( "expected 3 angles for --max-radius-angles" );
+      std::copy( angles.begin(), angles.end(), options.max_radius_angles );
+    }
+
+    else if ( arg == "--anisotropy" && hasValue )
+    {
+      std::vector< double > ranges;
+      if ( parseNumbers( argv[++a], ranges ) != 3 )
+        die( "expected 3 ranges for --anisotropy" );
+      std::copy( ranges.begin(), ranges.end(), options.anisotropy );
+    }
+
+    else if ( arg == "--anisotropy-angles" && hasValue )
+    {
+      std::vector< double > angles;
+      if ( parseNumbers( argv[++a], angles ) != 3 )
+        die( "expected 3 angles for --anisotropy-angles" );
+      std::copy( angles.begin(), angles.end(), options.anisotropy_angles );
+    }
+
+    else if ( arg == "--dem" && hasValue )
+      readDem( argv[++a], options, elevations );
+
+    else if ( arg == "--block-model" && hasValue )
+    {
+      std::vector< double > values;
+      if ( parseNumbers( argv[++a], values ) != 9 )
+        die( "expected 9 numbers for --block-model" );
+      for ( int axis = 0; axis < 3; axis++ )
+      {
+        options.block_origin[axis] = values[axis];
+        options.block_size[axis] = values[3 + axis];
+        options.block_count[axis] = int( values[6 + axis] );
+      }
+    }
+
+    else if ( arg == "--locate" && hasValue )
+      queryFile = argv[++a];
+
+    else if ( arg == "--tiles" && hasValue )
+    {
+      if ( sscanf( argv[++a], "%d,%d,%d", tiles, tiles + 1, tiles + 2 ) != 3 )
+        die( "expected three comma separated numbers of tiles" );
+    }
+
+    else if ( arg == "--halo" && hasValue )
+      halo = atof( argv[++a] );
+
+    else if ( ( arg == "-f" || arg == "--format" ) && hasValue )
+    {
+      std::string format = argv[++a];
+      stream = -1;
+      if ( format == "wkt" )
+        stream = VORO3D_STREAM_WKT;
+      else if ( format == "geojson" )
+        stream = VORO3D_STREAM_GEOJSON;
+      else if ( format == "csv" )
+        stream = VORO3D_STREAM_CSV;
+      else if ( format == "wkb" )
+        options.output = VORO3D_WKB;
+      else if ( format == "mesh" )
+        options.output = VORO3D_MESH;
+      else if ( format == "volume" )
+        options.output = VORO3D_VOLUME;
+      else if ( format == "adjacency" )
+        options.output = VORO3D_ADJACENCY;
+      else if ( format == "blocks" )
+        options.output = VORO3D_BLOCKS;
+      else
+        die( "unknown format ", format.c_str() );
+    }
+
+    else if ( arg.size() > 1 && arg[0] == '-' )
+    {
+      usage( stderr );
+      die( "unknown or incomplete option ", arg.c_str() );
+    }
+
+    else
+      files.push_back( argv[a] );
+  }
+
+  if ( files.size() != 2 )
+  {
+    usage( stderr );
+    return 1;
+  }
+
+  options.planes = planes.data();
+  options.plane_count = planes.size() / 4;
+  options.cylinders = cylinders.data();
+  options.cylinder_count = cylinders.size() / 7;
+  options.prism_x = prismX.data();
+  options.prism_y = prismY.data();
+  options.prism_vertices = prismX.size();
+
+  if ( !input.empty() && input != "csv" && input != "bin" )
+    die( "unknown input type ", input.c_str() );
+
+  bool toStdout = strcmp( files[1], "-" ) == 0;
+  FILE* out;
+
+  if ( tiles[0] != 0 )
+  {
+    size_t length = strlen( files[0] );
+    if ( input == "csv" || ( input.empty() && length > 4 &&
+                             strcmp( files[0] + length - 4, ".csv" ) == 0 ) )
+      die( "--tiles needs a binary input" );
+    if ( weighted || queryFile )
+      die( "--tiles cannot be combined with --radius or --locate" );
+    if ( stream < 0 )
+      die( "--tiles needs --format geojson or csv" );
+
+    out = toStdout ? stdout : fopen( files[1], "w" );
+    if ( !out )
+      die( "cannot open output: ", strerror( errno ) );
+
+    if ( voro3d_stream_tiles( files[0], &options, tiles, halo,
+                              stream, out, NULL ) != VORO3D_OK )
+      die( voro3d_last_error() );
+
+    if ( ( !toStdout && fclose( out ) != 0 ) || ( toStdout && fflush( out ) != 0 ) )
+      die( "cannot write output: ", strerror( errno ) );
+
+    return 0;
+  }
+
+  std::vector< std::vector< double > > columns ( weighted ? 4 : 3 );
+  readInput( files[0], input, columns );
+
+  const std::vector< double >& x = columns[0];
+  const std::vector< double >& y = columns[1];
+  const std::vector< double >& z = columns[2];
+  if ( weighted )
+    options.radius = columns[3].data();
+
+  if ( queryFile )
+  {
+    std::vector< std::vector< double > > queries ( 3 );
+    readInput( queryFile, input, queries );
+
+    size_t count = queries[0].size();
+    std::vector< int > index ( count );
+    std::vector< double > distance ( count );
+    if ( voro3d_locate( x.data(), y.data(), z.data(), x.size(),
+                        queries[0].data(), queries[1].data(), queries[2].data(),
+                        count, &options, index.data(), distance.data() ) != VORO3D_OK )
+      die( voro3d_last_error() );
+
+    out = toStdout ? stdout : fopen( files[1], "w" );
+    if ( !out )
+      die( "cannot open output: ", strerror( errno ) );
+
+    for ( size_t q = 0; q < count; q++ )
+    {
+      if ( index[q] < 0 )
+        fputs( "NA,NA\n", out );
+      else
+        fprintf( out, "%d,%.17g\n", index[q] + 1, distance[q] );
+    }
+  }
+  else if ( stream >= 0 )
+  {
+    out = toStdout ? stdout : fopen( files[1], "w" );
+    if ( !out )
+      die( "cannot open output: ", strerror( errno ) );
+
+    if ( voro3d_stream( x.data(), y.data(), z.data(), x.size(),
+                        &options, stream, out, NULL ) != VORO3D_OK )
+      die( voro3d_last_error() );
+  }
+  else
+  {
+    voro3d_result* result;
+    if ( voro3d_compute( x.data(), y.data(), z.data(), x.size(),
+                         &options, &result ) != VORO3D_OK )
+      die( voro3d_last_error() );
+
+    out = toStdout ? stdout : fopen( files[1], "w" );
+    if ( !out )
+      die( "cannot open output: ", strerror( errno ) );
+
+    writeOutput( out, result, options.output );
+    voro3d_free( result );
+  }
+
+  if ( ( !toStdout && fclose( out ) != 0 ) || ( toStdout && fflush( out ) != 0 ) )
+    die( "cannot write output: ", strerror( errno ) );
+
+  return 0;
+}
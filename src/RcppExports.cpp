@@ -11,8 +11,8 @@ Rcpp::Rostream<false>& Rcpp::Rcerr = Rcpp::Rcpp_cerr_get();
 #endif
 
 // voronoi
-Rcpp::StringVector voronoi(Rcpp::NumericVector x, Rcpp::NumericVector y, Rcpp::NumericVector z, double containerRatio);
-RcppExport SEXP _voro3d_voronoi(SEXP xSEXP, SEXP ySEXP, SEXP zSEXP, SEXP containerRatioSEXP) {
+SEXP voronoi(Rcpp::NumericVector x, Rcpp::NumericVector y, Rcpp::NumericVector z, double containerRatio, int threads, std::string output, bool polygons, int precision, bool profile, std::string grid, Rcpp::Nullable< Rcpp::IntegerVector > blocks, int initMem, Rcpp::RObject group, Rcpp::Nullable< Rcpp::List > walls, Rcpp::Nullable< Rcpp::List > dem, Rcpp::Nullable< Rcpp::NumericVector > maxRadius, Rcpp::NumericVector maxRadiusAngles, Rcpp::Nullable< Rcpp::NumericVector > anisotropy, Rcpp::NumericVector anisotropyAngles, Rcpp::Nullable< Rcpp::NumericVector > radius, Rcpp::Nullable< Rcpp::List > blockModel);
+RcppExport SEXP _voro3d_voronoi(SEXP xSEXP, SEXP ySEXP, SEXP zSEXP, SEXP containerRatioSEXP, SEXP threadsSEXP, SEXP outputSEXP, SEXP polygonsSEXP, SEXP precisionSEXP, SEXP profileSEXP, SEXP gridSEXP, SEXP blocksSEXP, SEXP initMemSEXP, SEXP groupSEXP, SEXP wallsSEXP, SEXP demSEXP, SEXP maxRadiusSEXP, SEXP maxRadiusAnglesSEXP, SEXP anisotropySEXP, SEXP anisotropyAnglesSEXP, SEXP radiusSEXP, SEXP blockModelSEXP) {
 BEGIN_RCPP
     Rcpp::RObject rcpp_result_gen;
     Rcpp::RNGScope rcpp_rngScope_gen;
@@ -20,17 +20,240 @@ BEGIN_RCPP
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type y(ySEXP);
     Rcpp::traits::input_parameter< Rcpp::NumericVector >::type z(zSEXP);
     Rcpp::traits::input_parameter< double >::type containerRatio(containerRatioSEXP);
-    rcpp_result_gen = Rcpp::wrap(voronoi(x, y, z, containerRatio));
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< bool >::type polygons(polygonsSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< bool >::type profile(profileSEXP);
+    Rcpp::traits::input_parameter< std::string >::type grid(gridSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::IntegerVector > >::type blocks(blocksSEXP);
+    Rcpp::traits::input_parameter< int >::type initMem(initMemSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type group(groupSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::List > >::type walls(wallsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::List > >::type dem(demSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type maxRadius(maxRadiusSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type maxRadiusAngles(maxRadiusAnglesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type anisotropy(anisotropySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type anisotropyAngles(anisotropyAnglesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type radius(radiusSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::List > >::type blockModel(blockModelSEXP);
+    rcpp_result_gen = Rcpp::wrap(voronoi(x, y, z, containerRatio, threads, output, polygons, precision, profile, grid, blocks, initMem, group, walls, dem, maxRadius, maxRadiusAngles, anisotropy, anisotropyAngles, radius, blockModel));
+    return rcpp_result_gen;
+END_RCPP
+}
+// voronoi_volume
+Rcpp::NumericVector voronoi_volume(Rcpp::NumericVector x, Rcpp::NumericVector y, Rcpp::NumericVector z, double containerRatio, int threads, std::string grid, Rcpp::Nullable< Rcpp::IntegerVector > blocks, int initMem, Rcpp::RObject group, Rcpp::Nullable< Rcpp::List > walls, Rcpp::Nullable< Rcpp::List > dem, Rcpp::Nullable< Rcpp::NumericVector > maxRadius, Rcpp::NumericVector maxRadiusAngles, Rcpp::Nullable< Rcpp::NumericVector > anisotropy, Rcpp::NumericVector anisotropyAngles, Rcpp::Nullable< Rcpp::NumericVector > radius);
+RcppExport SEXP _voro3d_voronoi_volume(SEXP xSEXP, SEXP ySEXP, SEXP zSEXP, SEXP containerRatioSEXP, SEXP threadsSEXP, SEXP gridSEXP, SEXP blocksSEXP, SEXP initMemSEXP, SEXP groupSEXP, SEXP wallsSEXP, SEXP demSEXP, SEXP maxRadiusSEXP, SEXP maxRadiusAnglesSEXP, SEXP anisotropySEXP, SEXP anisotropyAnglesSEXP, SEXP radiusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type z(zSEXP);
+    Rcpp::traits::input_parameter< double >::type containerRatio(containerRatioSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type grid(gridSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::IntegerVector > >::type blocks(blocksSEXP);
+    Rcpp::traits::input_parameter< int >::type initMem(initMemSEXP);
+    Rcpp::traits::input_parameter< Rcpp::RObject >::type group(groupSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::List > >::type walls(wallsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::List > >::type dem(demSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type maxRadius(maxRadiusSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type maxRadiusAngles(maxRadiusAnglesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type anisotropy(anisotropySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type anisotropyAngles(anisotropyAnglesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type radius(radiusSEXP);
+    rcpp_result_gen = Rcpp::wrap(voronoi_volume(x, y, z, containerRatio, threads, grid, blocks, initMem, group, walls, dem, maxRadius, maxRadiusAngles, anisotropy, anisotropyAngles, radius));
+    return rcpp_result_gen;
+END_RCPP
+}
+// voronoi_write
+double voronoi_write(Rcpp::NumericVector x, Rcpp::NumericVector y, Rcpp::NumericVector z, double containerRatio, std::string file, std::string format, int threads, bool polygons, int precision, std::string grid, Rcpp::Nullable< Rcpp::IntegerVector > blocks, int initMem, Rcpp::Nullable< Rcpp::List > walls, Rcpp::Nullable< Rcpp::List > dem, Rcpp::Nullable< Rcpp::NumericVector > maxRadius, Rcpp::NumericVector maxRadiusAngles, Rcpp::Nullable< Rcpp::NumericVector > anisotropy, Rcpp::NumericVector anisotropyAngles, Rcpp::Nullable< Rcpp::NumericVector > radius);
+RcppExport SEXP _voro3d_voronoi_write(SEXP xSEXP, SEXP ySEXP, SEXP zSEXP, SEXP containerRatioSEXP, SEXP fileSEXP, SEXP formatSEXP, SEXP threadsSEXP, SEXP polygonsSEXP, SEXP precisionSEXP, SEXP gridSEXP, SEXP blocksSEXP, SEXP initMemSEXP, SEXP wallsSEXP, SEXP demSEXP, SEXP maxRadiusSEXP, SEXP maxRadiusAnglesSEXP, SEXP anisotropySEXP, SEXP anisotropyAnglesSEXP, SEXP radiusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type z(zSEXP);
+    Rcpp::traits::input_parameter< double >::type containerRatio(containerRatioSEXP);
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< std::string >::type format(formatSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type polygons(polygonsSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< std::string >::type grid(gridSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::IntegerVector > >::type blocks(blocksSEXP);
+    Rcpp::traits::input_parameter< int >::type initMem(initMemSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::List > >::type walls(wallsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::List > >::type dem(demSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type maxRadius(maxRadiusSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type maxRadiusAngles(maxRadiusAnglesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type anisotropy(anisotropySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type anisotropyAngles(anisotropyAnglesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type radius(radiusSEXP);
+    rcpp_result_gen = Rcpp::wrap(voronoi_write(x, y, z, containerRatio, file, format, threads, polygons, precision, grid, blocks, initMem, walls, dem, maxRadius, maxRadiusAngles, anisotropy, anisotropyAngles, radius));
+    return rcpp_result_gen;
+END_RCPP
+}
+// voronoi_tiles
+Rcpp::DataFrame voronoi_tiles(std::string input, std::string file, double containerRatio, Rcpp::IntegerVector tiles, double halo, std::string format, int threads, bool polygons, int precision, std::string grid, Rcpp::Nullable< Rcpp::IntegerVector > blocks, int initMem, Rcpp::Nullable< Rcpp::List > walls, Rcpp::Nullable< Rcpp::List > dem, Rcpp::Nullable< Rcpp::NumericVector > maxRadius, Rcpp::NumericVector maxRadiusAngles);
+RcppExport SEXP _voro3d_voronoi_tiles(SEXP inputSEXP, SEXP fileSEXP, SEXP containerRatioSEXP, SEXP tilesSEXP, SEXP haloSEXP, SEXP formatSEXP, SEXP threadsSEXP, SEXP polygonsSEXP, SEXP precisionSEXP, SEXP gridSEXP, SEXP blocksSEXP, SEXP initMemSEXP, SEXP wallsSEXP, SEXP demSEXP, SEXP maxRadiusSEXP, SEXP maxRadiusAnglesSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< std::string >::type input(inputSEXP);
+    Rcpp::traits::input_parameter< std::string >::type file(fileSEXP);
+    Rcpp::traits::input_parameter< double >::type containerRatio(containerRatioSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type tiles(tilesSEXP);
+    Rcpp::traits::input_parameter< double >::type halo(haloSEXP);
+    Rcpp::traits::input_parameter< std::string >::type format(formatSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< bool >::type polygons(polygonsSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< std::string >::type grid(gridSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::IntegerVector > >::type blocks(blocksSEXP);
+    Rcpp::traits::input_parameter< int >::type initMem(initMemSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::List > >::type walls(wallsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::List > >::type dem(demSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type maxRadius(maxRadiusSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type maxRadiusAngles(maxRadiusAnglesSEXP);
+    rcpp_result_gen = Rcpp::wrap(voronoi_tiles(input, file, containerRatio, tiles, halo, format, threads, polygons, precision, grid, blocks, initMem, walls, dem, maxRadius, maxRadiusAngles));
+    return rcpp_result_gen;
+END_RCPP
+}
+// voronoi_locate
+Rcpp::DataFrame voronoi_locate(Rcpp::NumericVector x, Rcpp::NumericVector y, Rcpp::NumericVector z, Rcpp::NumericVector qx, Rcpp::NumericVector qy, Rcpp::NumericVector qz, int threads, std::string grid);
+RcppExport SEXP _voro3d_voronoi_locate(SEXP xSEXP, SEXP ySEXP, SEXP zSEXP, SEXP qxSEXP, SEXP qySEXP, SEXP qzSEXP, SEXP threadsSEXP, SEXP gridSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type z(zSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type qx(qxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type qy(qySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type qz(qzSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type grid(gridSEXP);
+    rcpp_result_gen = Rcpp::wrap(voronoi_locate(x, y, z, qx, qy, qz, threads, grid));
+    return rcpp_result_gen;
+END_RCPP
+}
+// voronoi_diagram
+SEXP voronoi_diagram(Rcpp::NumericVector x, Rcpp::NumericVector y, Rcpp::NumericVector z, double containerRatio, int threads, std::string grid, Rcpp::Nullable< Rcpp::IntegerVector > blocks, int initMem, Rcpp::Nullable< Rcpp::List > walls, Rcpp::Nullable< Rcpp::NumericVector > maxRadius, Rcpp::NumericVector maxRadiusAngles, Rcpp::Nullable< Rcpp::NumericVector > anisotropy, Rcpp::NumericVector anisotropyAngles, Rcpp::Nullable< Rcpp::NumericVector > radius);
+RcppExport SEXP _voro3d_voronoi_diagram(SEXP xSEXP, SEXP ySEXP, SEXP zSEXP, SEXP containerRatioSEXP, SEXP threadsSEXP, SEXP gridSEXP, SEXP blocksSEXP, SEXP initMemSEXP, SEXP wallsSEXP, SEXP maxRadiusSEXP, SEXP maxRadiusAnglesSEXP, SEXP anisotropySEXP, SEXP anisotropyAnglesSEXP, SEXP radiusSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type z(zSEXP);
+    Rcpp::traits::input_parameter< double >::type containerRatio(containerRatioSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type grid(gridSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::IntegerVector > >::type blocks(blocksSEXP);
+    Rcpp::traits::input_parameter< int >::type initMem(initMemSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::List > >::type walls(wallsSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type maxRadius(maxRadiusSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type maxRadiusAngles(maxRadiusAnglesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type anisotropy(anisotropySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type anisotropyAngles(anisotropyAnglesSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type radius(radiusSEXP);
+    rcpp_result_gen = Rcpp::wrap(voronoi_diagram(x, y, z, containerRatio, threads, grid, blocks, initMem, walls, maxRadius, maxRadiusAngles, anisotropy, anisotropyAngles, radius));
+    return rcpp_result_gen;
+END_RCPP
+}
+// diagram_cells
+SEXP diagram_cells(SEXP diagram, Rcpp::Nullable< Rcpp::IntegerVector > ids, std::string output, bool polygons, int precision, int threads);
+RcppExport SEXP _voro3d_diagram_cells(SEXP diagramSEXP, SEXP idsSEXP, SEXP outputSEXP, SEXP polygonsSEXP, SEXP precisionSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type diagram(diagramSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::IntegerVector > >::type ids(idsSEXP);
+    Rcpp::traits::input_parameter< std::string >::type output(outputSEXP);
+    Rcpp::traits::input_parameter< bool >::type polygons(polygonsSEXP);
+    Rcpp::traits::input_parameter< int >::type precision(precisionSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(diagram_cells(diagram, ids, output, polygons, precision, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// diagram_locate
+Rcpp::DataFrame diagram_locate(SEXP diagram, Rcpp::NumericVector qx, Rcpp::NumericVector qy, Rcpp::NumericVector qz, int threads);
+RcppExport SEXP _voro3d_diagram_locate(SEXP diagramSEXP, SEXP qxSEXP, SEXP qySEXP, SEXP qzSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type diagram(diagramSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type qx(qxSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type qy(qySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type qz(qzSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(diagram_locate(diagram, qx, qy, qz, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// diagram_insert
+Rcpp::IntegerVector diagram_insert(SEXP diagram, Rcpp::NumericVector x, Rcpp::NumericVector y, Rcpp::NumericVector z, Rcpp::Nullable< Rcpp::NumericVector > radius, int threads);
+RcppExport SEXP _voro3d_diagram_insert(SEXP diagramSEXP, SEXP xSEXP, SEXP ySEXP, SEXP zSEXP, SEXP radiusSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type diagram(diagramSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type x(xSEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type y(ySEXP);
+    Rcpp::traits::input_parameter< Rcpp::NumericVector >::type z(zSEXP);
+    Rcpp::traits::input_parameter< Rcpp::Nullable< Rcpp::NumericVector > >::type radius(radiusSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(diagram_insert(diagram, x, y, z, radius, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// diagram_delete
+Rcpp::IntegerVector diagram_delete(SEXP diagram, Rcpp::IntegerVector ids, int threads);
+RcppExport SEXP _voro3d_diagram_delete(SEXP diagramSEXP, SEXP idsSEXP, SEXP threadsSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type diagram(diagramSEXP);
+    Rcpp::traits::input_parameter< Rcpp::IntegerVector >::type ids(idsSEXP);
+    Rcpp::traits::input_parameter< int >::type threads(threadsSEXP);
+    rcpp_result_gen = Rcpp::wrap(diagram_delete(diagram, ids, threads));
+    return rcpp_result_gen;
+END_RCPP
+}
+// diagram_info
+Rcpp::List diagram_info(SEXP diagram);
+RcppExport SEXP _voro3d_diagram_info(SEXP diagramSEXP) {
+BEGIN_RCPP
+    Rcpp::RObject rcpp_result_gen;
+    Rcpp::RNGScope rcpp_rngScope_gen;
+    Rcpp::traits::input_parameter< SEXP >::type diagram(diagramSEXP);
+    rcpp_result_gen = Rcpp::wrap(diagram_info(diagram));
     return rcpp_result_gen;
 END_RCPP
 }
 
 static const R_CallMethodDef CallEntries[] = {
-    {"_voro3d_voronoi", (DL_FUNC) &_voro3d_voronoi, 4},
+    {"_voro3d_voronoi", (DL_FUNC) &_voro3d_voronoi, 21},
+    {"_voro3d_voronoi_volume", (DL_FUNC) &_voro3d_voronoi_volume, 16},
+    {"_voro3d_voronoi_write", (DL_FUNC) &_voro3d_voronoi_write, 19},
+    {"_voro3d_voronoi_tiles", (DL_FUNC) &_voro3d_voronoi_tiles, 16},
+    {"_voro3d_voronoi_locate", (DL_FUNC) &_voro3d_voronoi_locate, 8},
+    {"_voro3d_voronoi_diagram", (DL_FUNC) &_voro3d_voronoi_diagram, 14},
+    {"_voro3d_diagram_cells", (DL_FUNC) &_voro3d_diagram_cells, 6},
+    {"_voro3d_diagram_locate", (DL_FUNC) &_voro3d_diagram_locate, 5},
+    {"_voro3d_diagram_insert", (DL_FUNC) &_voro3d_diagram_insert, 6},
+    {"_voro3d_diagram_delete", (DL_FUNC) &_voro3d_diagram_delete, 3},
+    {"_voro3d_diagram_info", (DL_FUNC) &_voro3d_diagram_info, 1},
     {NULL, NULL, 0}
 };
 
+void registerWktVector(DllInfo* dll);
 RcppExport void R_init_voro3d(DllInfo *dll) {
     R_registerRoutines(dll, NULL, CallEntries, NULL, NULL);
     R_useDynamicSymbols(dll, FALSE);
+    registerWktVector(dll);
 }
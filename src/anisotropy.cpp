@@ -0,0 +1,50 @@
+#include <math.h>
+#include "anisotropy.h"
+
+Anisotropy::Anisotropy( const Ellipsoid& ellipsoid )
+{
+  double axes[3][3];
+  ellipsoidAxes( ellipsoid, axes );
+  const double* ranges = ellipsoid.ranges;
+
+  // The coordinate along each axis is scaled by the major range over the
+  // range of the axis. The axes are orthonormal, so the inverse scales back
+  // and rotates by the transpose.
+  ratio = 1;
+  for ( int a = 0; a < 3; a++ )
+  {
+    double scale = ranges[0] / ranges[a];
+    ratio /= scale;
+    for ( int b = 0; b < 3; b++ )
+    {
+      to[a][b] = scale * axes[a][b];
+      back[b][a] = axes[a][b] / scale;
+    }
+  }
+}
+
+double Anisotropy::areaRatio( const double* normal ) const
+{
+  // Areas scale by the determinant of the inverse times the length of the
+  // normal mapped by its inverse transpose, which is the transpose of `to`
+  double mapped[3];
+  for ( int a = 0; a < 3; a++ )
+    mapped[a] = to[0][a] * normal[0] + to[1][a] * normal[1] + to[2][a] * normal[2];
+
+  return ratio * sqrt( mapped[0] * mapped[0] + mapped[1] * mapped[1] + mapped[2] * mapped[2] );
+}
+
+Walls Anisotropy::walls( const Walls& walls ) const
+{
+  // a . p <= d becomes ( back^T a ) . q <= d for q = to p
+  Walls mapped;
+  for ( const PlaneWall& plane : walls.planes )
+  {
+    double normal[3];
+    for ( int a = 0; a < 3; a++ )
+      normal[a] = back[0][a] * plane.a + back[1][a] * plane.b + back[2][a] * plane.c;
+    mapped.planes.push_back( PlaneWall { normal[0], normal[1], normal[2], plane.d } );
+  }
+
+  return mapped;
+}
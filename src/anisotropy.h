@@ -0,0 +1,41 @@
+#ifndef ANISOTROPY_H
+#define ANISOTROPY_H
+
+#include "ellipsoid.h"
+#include "walls.h"
+
+// Linear map of the coordinates to an isotropic space, where the anisotropy
+// ellipsoid becomes a sphere with the major range as radius. Cells computed
+// there follow the continuity of the data; their offsets from the points are
+// mapped back by `inverse()`.
+class Anisotropy
+{
+public:
+  explicit Anisotropy( const Ellipsoid& ellipsoid );
+
+  // Map the point (x, y, z) to the isotropic space
+  void forward( double x, double y, double z, double* position ) const
+  {
+    for ( int a = 0; a < 3; a++ )
+      position[a] = to[a][0] * x + to[a][1] * y + to[a][2] * z;
+  }
+
+  // Matrix mapping offsets in the isotropic space back, stored by rows
+  const double* inverse() const { return back[0]; }
+
+  // Ratio of volumes in the original space to volumes in the isotropic space
+  double volumeRatio() const { return ratio; }
+
+  // Ratio of the area of a face in the original space to its area in the
+  // isotropic space, for the unit `normal` of the face in the isotropic space
+  double areaRatio( const double* normal ) const;
+
+  // Planes of `walls` in the isotropic space. Cylinders cannot be mapped.
+  Walls walls( const Walls& walls ) const;
+
+private:
+  double to[3][3], back[3][3];
+  double ratio;
+};
+
+#endif
@@ -0,0 +1,135 @@
+#include <algorithm>
+#include <climits>
+#include <math.h>
+#include <stdexcept>
+#include "blockModel.h"
+
+void checkBlockModel( const BlockModel& model )
+{
+  for ( int a = 0; a < 3; a++ )
+  {
+    if ( !isfinite( model.origin[a] ) )
+      throw std::invalid_argument( "Invalid blockModel: Origin must be finite." );
+
+    if ( !( model.size[a] > 0 ) || !isfinite( model.size[a] ) )
+      throw std::invalid_argument( "Invalid blockModel: Block sizes must be positive and finite." );
+
+    if ( model.count[a] < 1 )
+      throw std::invalid_argument( "Invalid blockModel: Block counts must be positive." );
+  }
+
+  if ( double( model.count[0] ) * model.count[1] * model.count[2] > INT_MAX )
+    throw std::invalid_argument( "Invalid blockModel: Too many blocks to be indexed with integers." );
+}
+
+BlockSplitter::BlockSplitter( const BlockModel& model,
+                              const double* offsetMap,
+                              double volumeRatio )
+  : model( model ), volumeRatio( volumeRatio )
+{
+  // The coordinate of the model along an axis is the coordinate of the point
+  // plus the row of the map times the offset of the cell
+  for ( int a = 0; a < 3; a++ )
+  {
+    double length = 0;
+    for ( int b = 0; b < 3; b++ )
+    {
+      normals[a][b] = offsetMap ? offsetMap[3 * a + b] : a == b;
+      length += normals[a][b] * normals[a][b];
+    }
+
+    length = sqrt( length );
+    for ( int b = 0; b < 3; b++ )
+      normals[a][b] /= length;
+    lengths[a] = length;
+  }
+}
+
+bool BlockSplitter::cut( voro::voronoicell& c, int axis, double sign, double bound )
+{
+  const double* normal = normals[axis];
+  double offset = sign * ( bound - particle[axis] ) / lengths[axis];
+  return c.plane( sign * normal[0], sign * normal[1], sign * normal[2], 2 * offset );
+}
+
+bool BlockSplitter::cutBlock( voro::voronoicell& c, int axis, int b )
+{
+  double lower = model.origin[axis] + b * model.size[axis];
+  double upper = lower + model.size[axis];
+
+  if ( cellLow[axis] < lower && !cut( c, axis, -1, lower ) )
+    return false;
+
+  return cellHigh[axis] <= upper || cut( c, axis, 1, upper );
+}
+
+void BlockSplitter::split( voro::voronoicell& vc, double x, double y, double z,
+                           std::vector< int >& blocks, std::vector< double >& volumes )
+{
+  particle[0] = x;
+  particle[1] = y;
+  particle[2] = z;
+
+  // Vertices are stored at twice their offset from the particle, in the
+  // space of the cell
+  for ( int v = 0; v < vc.p; v++ )
+  {
+    const double* offset = vc.pts + 3 * v;
+    for ( int a = 0; a < 3; a++ )
+    {
+      const double* normal = normals[a];
+      double position = particle[a] + 0.5 * lengths[a] *
+        ( normal[0] * offset[0] + normal[1] * offset[1] + normal[2] * offset[2] );
+      cellLow[a] = v == 0 ? position : std::min( cellLow[a], position );
+      cellHigh[a] = v == 0 ? position : std::max( cellHigh[a], position );
+    }
+  }
+
+  // Blocks within the bounding box of the cell. Blocks that the cell only
+  // touches within rounding errors, such as the next block when a face of
+  // the cell is on a face of the model, are not visited.
+  const double tolerance = 1e-9;
+  int first[3], last[3];
+  for ( int a = 0; a < 3; a++ )
+  {
+    double low = ( cellLow[a] - model.origin[a] ) / model.size[a];
+    double high = ( cellHigh[a] - model.origin[a] ) / model.size[a];
+    low = std::max( 0.0, floor( low + tolerance ) );
+    high = std::min( model.count[a] - 1.0, ceil( high - tolerance ) - 1 );
+    if ( low > high )
+      return;
+
+    first[a] = int( low );
+    last[a] = int( high );
+  }
+
+  // Split the cell into slabs along z, rows along y and blocks along x, so
+  // the blocks are visited in increasing order
+  for ( int k = first[2]; k <= last[2]; k++ )
+  {
+    slab = vc;
+    if ( !cutBlock( slab, 2, k ) )
+      continue;
+
+    for ( int j = first[1]; j <= last[1]; j++ )
+    {
+      row = slab;
+      if ( !cutBlock( row, 1, j ) )
+        continue;
+
+      for ( int i = first[0]; i <= last[0]; i++ )
+      {
+        piece = row;
+        if ( !cutBlock( piece, 0, i ) )
+          continue;
+
+        double volume = piece.volume() * volumeRatio;
+        if ( volume > 0 )
+        {
+          blocks.push_back( i + model.count[0] * ( j + model.count[1] * k ) );
+          volumes.push_back( volume );
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,65 @@
+#ifndef BLOCK_MODEL_H
+#define BLOCK_MODEL_H
+
+#include <vector>
+#include <voro++.hh>
+
+// Regular model of `count[0]` by `count[1]` by `count[2]` blocks of `size`,
+// whose first block has its lower corner at `origin`. Block (i, j, k) has the
+// index i + count[0] ( j + count[1] k ).
+struct BlockModel
+{
+  double origin[3] = { 0, 0, 0 };
+  double size[3] = { 0, 0, 0 };
+  int count[3] = { 0, 0, 0 };
+
+  bool empty() const { return count[0] == 0 && count[1] == 0 && count[2] == 0; }
+};
+
+// Check that the origin is finite, the sizes positive and finite and the
+// counts positive
+void checkBlockModel( const BlockModel& model );
+
+// Splits cells by the blocks of a model. Only the blocks within the bounding
+// box of a cell are visited, and a cell is cut only by the faces of a block
+// that it crosses. Each thread needs its own splitter.
+class BlockSplitter
+{
+public:
+  // If `offsetMap` is not null, the cells are computed in a space whose
+  // offsets from the points it maps, by rows, to the space of the model, and
+  // `volumeRatio` scales their volumes to that space.
+  explicit BlockSplitter( const BlockModel& model,
+                          const double* offsetMap = nullptr,
+                          double volumeRatio = 1 );
+
+  // Append the index of each block overlapped by the cell `vc` of the point
+  // (x, y, z) to `blocks`, and the volume of the cell within it to
+  // `volumes`. Parts of the cell outside of the model are left out.
+  void split( voro::voronoicell& vc, double x, double y, double z,
+              std::vector< int >& blocks, std::vector< double >& volumes );
+
+private:
+  const BlockModel& model;
+
+  // Unit normal, in the space of the cells, of the faces of the blocks along
+  // each axis, and the length of the row of the map it was scaled from
+  double normals[3][3], lengths[3];
+  double volumeRatio;
+
+  // Coordinates of the point and bounds of the cell, set by `split()`
+  double particle[3];
+  double cellLow[3], cellHigh[3];
+
+  // Scratch space
+  voro::voronoicell slab, row, piece;
+
+  // Keep the part of `c` within block `b` along `axis`. Returns false if
+  // nothing is left.
+  bool cutBlock( voro::voronoicell& c, int axis, int b );
+
+  // Keep the part of `c` where sign x[axis] < sign bound
+  bool cut( voro::voronoicell& c, int axis, double sign, double bound );
+};
+
+#endif
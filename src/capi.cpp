@@ -0,0 +1,471 @@
+#include <algorithm>
+#include <math.h>
+#include <new>
+#include <string>
+#include "engine.h"
+#include "locate.h"
+#include "tiles.h"
+#include "voro3d.h"
+
+struct voro3d_result
+{
+  CellOutput output;
+};
+
+static thread_local std::string lastError;
+
+// Record `message` as the last error and return `status`
+static int fail( int status, const char* message )
+{
+  lastError = message;
+  return status;
+}
+
+void voro3d_default_options( voro3d_options* options )
+{
+  CellOptions defaults;
+  options->container_ratio = defaults.containerRatio;
+  options->threads = defaults.threads;
+  options->output = VORO3D_WKT;
+  options->polygons = defaults.polygons;
+  options->precision = defaults.precision;
+  options->radius = NULL;
+  options->grid = VORO3D_GRID_UNIFORM;
+  for ( int a = 0; a < 3; a++ )
+    options->blocks[a] = defaults.grid.blocks[a];
+  options->init_mem = defaults.grid.initMem;
+  options->planes = NULL;
+  options->plane_count = 0;
+  options->prism_x = NULL;
+  options->prism_y = NULL;
+  options->prism_vertices = 0;
+  options->prism_z[0] = options->prism_z[1] = 0;
+  options->cylinders = NULL;
+  options->cylinder_count = 0;
+  for ( int a = 0; a < 3; a++ )
+  {
+    options->max_radius[a] = options->max_radius_angles[a] = 0;
+    options->anisotropy[a] = options->anisotropy_angles[a] = 0;
+  }
+  options->dem_z = NULL;
+  options->dem_nx = options->dem_ny = 0;
+  options->dem_x0 = options->dem_y0 = 0;
+  options->dem_dx = options->dem_dy = 1;
+  for ( int a = 0; a < 3; a++ )
+  {
+    options->block_origin[a] = options->block_size[a] = 0;
+    options->block_count[a] = 0;
+  }
+}
+
+// Convert `options` into `cellOptions`, except for the prism, which is added
+// by `addPrismWall()` since it can throw
+static int convertOptions( const voro3d_options* options, CellOptions& cellOptions )
+{
+  static const OutputFormat formats[] = { OUTPUT_WKT, OUTPUT_WKB,
+                                          OUTPUT_MESH, OUTPUT_VOLUME,
+                                          OUTPUT_ADJACENCY, OUTPUT_BLOCKS };
+  static const GridMode grids[] = { GRID_UNIFORM, GRID_TUNED, GRID_ANISOTROPIC };
+
+  if ( ( options->plane_count && !options->planes ) ||
+       ( options->cylinder_count && !options->cylinders ) ||
+       ( options->prism_vertices && ( !options->prism_x || !options->prism_y ) ) )
+    return fail( VORO3D_INVALID_ARGUMENT, "Null pointer argument." );
+
+  if ( options->output < VORO3D_WKT || options->output > VORO3D_BLOCKS )
+    return fail( VORO3D_INVALID_ARGUMENT, "Invalid output format." );
+
+  if ( options->grid < VORO3D_GRID_UNIFORM || options->grid > VORO3D_GRID_ANISOTROPIC )
+    return fail( VORO3D_INVALID_ARGUMENT, "Invalid grid." );
+
+  cellOptions.containerRatio = options->container_ratio;
+  cellOptions.threads = options->threads;
+  cellOptions.output = formats[options->output];
+  cellOptions.polygons = options->polygons != 0;
+  cellOptions.precision = options->precision;
+  cellOptions.grid.mode = grids[options->grid];
+  for ( int a = 0; a < 3; a++ )
+    cellOptions.grid.blocks[a] = options->blocks[a];
+  cellOptions.grid.initMem = options->init_mem;
+  for ( int a = 0; a < 3; a++ )
+  {
+    cellOptions.influence.ranges[a] = options->max_radius[a];
+    cellOptions.influence.angles[a] = options->max_radius_angles[a];
+    cellOptions.anisotropy.ranges[a] = options->anisotropy[a];
+    cellOptions.anisotropy.angles[a] = options->anisotropy_angles[a];
+    cellOptions.blockModel.origin[a] = options->block_origin[a];
+    cellOptions.blockModel.size[a] = options->block_size[a];
+    cellOptions.blockModel.count[a] = options->block_count[a];
+  }
+
+  for ( size_t i = 0; i < options->plane_count; i++ )
+  {
+    const double* plane = options->planes + 4 * i;
+    cellOptions.walls.planes.push_back(
+      PlaneWall { plane[0], plane[1], plane[2], plane[3] } );
+  }
+
+  for ( size_t i = 0; i < options->cylinder_count; i++ )
+  {
+    const double* cylinder = options->cylinders + 7 * i;
+    cellOptions.walls.cylinders.push_back(
+      CylinderWall { cylinder[0], cylinder[1], cylinder[2], cylinder[3],
+                     cylinder[4], cylinder[5], cylinder[6] } );
+  }
+
+  if ( options->dem_z )
+  {
+    Dem& dem = cellOptions.dem;
+    dem.x0 = options->dem_x0;
+    dem.y0 = options->dem_y0;
+    dem.dx = options->dem_dx;
+    dem.dy = options->dem_dy;
+    dem.nx = options->dem_nx;
+    dem.ny = options->dem_ny;
+    if ( dem.nx > 0 && dem.ny > 0 )
+      dem.z.assign( options->dem_z, options->dem_z + size_t( dem.nx ) * dem.ny );
+    else
+      return fail( VORO3D_INVALID_ARGUMENT, "Invalid dem: Grid must have at least 2 by 2 nodes." );
+  }
+
+  return VORO3D_OK;
+}
+
+// Add the prism of `options` to the walls of `cellOptions`
+static void addPrismWall( const voro3d_options* options, CellOptions& cellOptions )
+{
+  if ( options->prism_vertices )
+  {
+    addPrism( options->prism_x, options->prism_y, options->prism_vertices,
+              options->prism_z[0], options->prism_z[1], cellOptions.walls );
+  }
+}
+
+// Compute the cells of all points, or of each group if `group` is not null
+static int compute( const double* x, const double* y, const double* z,
+                    const int* group,
+                    size_t n,
+                    const voro3d_options* options,
+                    voro3d_result** result )
+{
+  if ( !x || !y || !z || !options || !result )
+    return fail( VORO3D_INVALID_ARGUMENT, "Null pointer argument." );
+
+  CellOptions cellOptions;
+  int status = convertOptions( options, cellOptions );
+  if ( status != VORO3D_OK )
+    return status;
+
+  *result = NULL;
+  voro3d_result* cells = NULL;
+
+  try
+  {
+    addPrismWall( options, cellOptions );
+    cells = new voro3d_result;
+    Points points { x, y, z, n };
+    points.radius = options->radius;
+    if ( group )
+      computeOutput( points, pointGroups( group, n ), cellOptions, cells->output );
+    else
+      computeOutput( points, cellOptions, cells->output );
+  }
+  catch ( const std::invalid_argument& error )
+  {
+    delete cells;
+    return fail( VORO3D_INVALID_ARGUMENT, error.what() );
+  }
+  catch ( const std::exception& error )
+  {
+    delete cells;
+    return fail( VORO3D_FAILURE, error.what() );
+  }
+  catch ( ... )
+  {
+    delete cells;
+    return fail( VORO3D_FAILURE, "Unknown error." );
+  }
+
+  *result = cells;
+  return VORO3D_OK;
+}
+
+int voro3d_compute( const double* x, const double* y, const double* z,
+                    size_t n,
+                    const voro3d_options* options,
+                    voro3d_result** result )
+{
+  return compute( x, y, z, NULL, n, options, result );
+}
+
+int voro3d_compute_grouped( const double* x, const double* y, const double* z,
+                            const int* group,
+                            size_t n,
+                            const voro3d_options* options,
+                            voro3d_result** result )
+{
+  if ( !group )
+    return fail( VORO3D_INVALID_ARGUMENT, "Null pointer argument." );
+
+  return compute( x, y, z, group, n, options, result );
+}
+
+int voro3d_locate( const double* x, const double* y, const double* z,
+                   size_t n,
+                   const double* qx, const double* qy, const double* qz,
+                   size_t query_count,
+                   const voro3d_options* options,
+                   int* index, double* distance )
+{
+  static const GridMode grids[] = { GRID_UNIFORM, GRID_TUNED, GRID_ANISOTROPIC };
+
+  if ( !x || !y || !z || !qx || !qy || !qz || !options || !index || !distance )
+    return fail( VORO3D_INVALID_ARGUMENT, "Null pointer argument." );
+
+  if ( options->grid < VORO3D_GRID_UNIFORM || options->grid > VORO3D_GRID_ANISOTROPIC )
+    return fail( VORO3D_INVALID_ARGUMENT, "Invalid grid." );
+
+  GridOptions grid;
+  grid.mode = grids[options->grid];
+  for ( int a = 0; a < 3; a++ )
+    grid.blocks[a] = options->blocks[a];
+  grid.initMem = options->init_mem;
+
+  try
+  {
+    std::vector< int > located;
+    std::vector< double > distances;
+    locatePoints( Points { x, y, z, n }, Points { qx, qy, qz, query_count },
+                  grid, options->threads, located, distances );
+    std::copy( located.begin(), located.end(), index );
+    std::copy( distances.begin(), distances.end(), distance );
+  }
+  catch ( const std::invalid_argument& error )
+  {
+    return fail( VORO3D_INVALID_ARGUMENT, error.what() );
+  }
+  catch ( const std::exception& error )
+  {
+    return fail( VORO3D_FAILURE, error.what() );
+  }
+  catch ( ... )
+  {
+    return fail( VORO3D_FAILURE, "Unknown error." );
+  }
+
+  return VORO3D_OK;
+}
+
+int voro3d_stream( const double* x, const double* y, const double* z,
+                   size_t n,
+                   const voro3d_options* options,
+                   int format,
+                   FILE* file,
+                   size_t* computed )
+{
+  static const StreamFormat formats[] = { STREAM_WKT, STREAM_GEOJSON, STREAM_CSV };
+
+  if ( !x || !y || !z || !options || !file )
+    return fail( VORO3D_INVALID_ARGUMENT, "Null pointer argument." );
+
+  if ( format < VORO3D_STREAM_WKT || format > VORO3D_STREAM_CSV )
+    return fail( VORO3D_INVALID_ARGUMENT, "Invalid stream format." );
+
+  CellOptions cellOptions;
+  int status = convertOptions( options, cellOptions );
+  if ( status != VORO3D_OK )
+    return status;
+
+  try
+  {
+    addPrismWall( options, cellOptions );
+
+    CellStream stream;
+    stream.file = file;
+    stream.format = formats[format];
+
+    Points points { x, y, z, n };
+    points.radius = options->radius;
+    CellOutput output;
+    streamOutput( points, cellOptions, stream, output );
+
+    if ( computed )
+      *computed = std::count( output.computed.begin(), output.computed.end(), 1 );
+  }
+  catch ( const std::invalid_argument& error )
+  {
+    return fail( VORO3D_INVALID_ARGUMENT, error.what() );
+  }
+  catch ( const std::exception& error )
+  {
+    return fail( VORO3D_FAILURE, error.what() );
+  }
+  catch ( ... )
+  {
+    return fail( VORO3D_FAILURE, "Unknown error." );
+  }
+
+  return VORO3D_OK;
+}
+
+int voro3d_stream_tiles( const char* path,
+                         const voro3d_options* options,
+                         const int* tiles,
+                         double halo,
+                         int format,
+                         FILE* file,
+                         size_t* computed )
+{
+  static const StreamFormat formats[] = { STREAM_WKT, STREAM_GEOJSON, STREAM_CSV };
+
+  if ( !path || !options || !tiles || !file )
+    return fail( VORO3D_INVALID_ARGUMENT, "Null pointer argument." );
+
+  if ( format < VORO3D_STREAM_WKT || format > VORO3D_STREAM_CSV )
+    return fail( VORO3D_INVALID_ARGUMENT, "Invalid stream format." );
+
+  if ( options->radius )
+    return fail( VORO3D_INVALID_ARGUMENT, "Invalid radius: Tiled runs do not support a radius." );
+
+  CellOptions cellOptions;
+  int status = convertOptions( options, cellOptions );
+  if ( status != VORO3D_OK )
+    return status;
+
+  try
+  {
+    addPrismWall( options, cellOptions );
+
+    TileOptions tileOptions;
+    std::copy( tiles, tiles + 3, tileOptions.tiles );
+    tileOptions.halo = halo;
+
+    CellStream stream;
+    stream.file = file;
+    stream.format = formats[format];
+
+    std::vector< TileReport > reports;
+    computeTiles( path, tileOptions, cellOptions, stream, reports );
+
+    if ( computed )
+    {
+      *computed = 0;
+      for ( const TileReport& report : reports )
+        *computed += report.computed;
+    }
+  }
+  catch ( const std::invalid_argument& error )
+  {
+    return fail( VORO3D_INVALID_ARGUMENT, error.what() );
+  }
+  catch ( const std::exception& error )
+  {
+    return fail( VORO3D_FAILURE, error.what() );
+  }
+  catch ( ... )
+  {
+    return fail( VORO3D_FAILURE, "Unknown error." );
+  }
+
+  return VORO3D_OK;
+}
+
+void voro3d_free( voro3d_result* result )
+{
+  delete result;
+}
+
+const char* voro3d_last_error( void )
+{
+  return lastError.c_str();
+}
+
+size_t voro3d_cells( const voro3d_result* result )
+{
+  return result->output.computed.size();
+}
+
+int voro3d_computed( const voro3d_result* result, size_t id )
+{
+  return id < voro3d_cells( result ) && result->output.computed[id];
+}
+
+const char* voro3d_wkt( const voro3d_result* result, size_t id,
+                        size_t* length )
+{
+  if ( !voro3d_computed( result, id ) || result->output.format != OUTPUT_WKT )
+    return NULL;
+
+  const std::string& text = result->output.wkt[id];
+  *length = text.size();
+  return text.data();
+}
+
+const unsigned char* voro3d_wkb( const voro3d_result* result, size_t id,
+                                 size_t* length )
+{
+  if ( !voro3d_computed( result, id ) || result->output.format != OUTPUT_WKB )
+    return NULL;
+
+  const std::vector< unsigned char >& binary = result->output.wkb[id];
+  *length = binary.size();
+  return binary.data();
+}
+
+double voro3d_volume( const voro3d_result* result, size_t id )
+{
+  if ( !voro3d_computed( result, id ) ||
+       result->output.format != OUTPUT_VOLUME )
+    return NAN;
+
+  return result->output.volume[id];
+}
+
+int voro3d_mesh( const voro3d_result* result, size_t id,
+                 const double** vertices, int* vertex_count,
+                 const int** faces, const int** face_sizes, int* face_count )
+{
+  if ( !voro3d_computed( result, id ) || result->output.format != OUTPUT_MESH )
+    return 0;
+
+  const MeshSlot& slot = result->output.slots[id];
+  const MeshChunk& chunk = result->output.chunks[slot.thread];
+  *vertices = chunk.vertices.data() + slot.vertex;
+  *vertex_count = slot.vertices;
+  *faces = chunk.faces.data() + slot.face;
+  *face_sizes = chunk.faceSizes.data() + slot.faceSize;
+  *face_count = slot.faces;
+  return 1;
+}
+
+int voro3d_adjacency( const voro3d_result* result, size_t id,
+                      const int** neighbours, const double** areas,
+                      int* face_count )
+{
+  if ( !voro3d_computed( result, id ) ||
+       result->output.format != OUTPUT_ADJACENCY )
+    return 0;
+
+  const AdjacencySlot& slot = result->output.adjacencySlots[id];
+  const AdjacencyChunk& chunk = result->output.adjacency[slot.thread];
+  *neighbours = chunk.neighbours.data() + slot.face;
+  *areas = chunk.areas.data() + slot.face;
+  *face_count = slot.faces;
+  return 1;
+}
+
+int voro3d_blocks( const voro3d_result* result, size_t id,
+                   const int** blocks, const double** volumes,
+                   int* block_count )
+{
+  if ( !voro3d_computed( result, id ) ||
+       result->output.format != OUTPUT_BLOCKS )
+    return 0;
+
+  const BlockSlot& slot = result->output.blockSlots[id];
+  const BlockChunk& chunk = result->output.blocks[slot.thread];
+  *blocks = chunk.blocks.data() + slot.part;
+  *volumes = chunk.volumes.data() + slot.part;
+  *block_count = slot.parts;
+  return 1;
+}
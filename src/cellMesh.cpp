@@ -0,0 +1,190 @@
+#include <algorithm>
+#include "cellMesh.h"
+#include "vec3.h"
+
+void CellMesh::orientedFaces( bool polygons, FaceList& list ) const
+{
+  const Vec3 particle ( x, y, z );
+  const double* v = vertices.data();
+  int aa, bb, cc, f, t;
+
+  list.vertices.clear();
+  list.offsets.clear();
+  list.offsets.push_back( 0 );
+
+  for ( f = 0; f < faces(); f++ )
+  {
+    aa = faceVertices[faceOffsets[f]];
+    const Vec3 origin = faceOrigins.empty() ? particle
+                                            : Vec3::at( faceOrigins.data() + 3 * f );
+
+    // Orientation of each triangle of the fan around the first vertex, from
+    // its corners gathered into separate coordinate arrays
+    int n = faceOffsets[f + 1] - faceOffsets[f] - 2;
+    list.fan.resize( 10 * size_t( std::max( n, 0 ) ) );
+    double* corner = list.fan.data();
+    double* orientation = corner + 9 * n;
+    for ( t = 0; t < n; t++ )
+    {
+      const double* b = v + 3 * faceVertices[faceOffsets[f] + 1 + t];
+      const double* c = v + 3 * faceVertices[faceOffsets[f] + 2 + t];
+      for ( int a = 0; a < 3; a++ )
+      {
+        corner[a * n + t] = v[3 * aa + a];
+        corner[( 3 + a ) * n + t] = b[a];
+        corner[( 6 + a ) * n + t] = c[a];
+      }
+    }
+    orientations( n, corner, corner + n, corner + 2 * n,
+                  corner + 3 * n, corner + 4 * n, corner + 5 * n,
+                  corner + 6 * n, corner + 7 * n, corner + 8 * n,
+                  origin, orientation );
+
+    if ( polygons )
+    {
+      // The sum of the orientations of the fan triangles is that of the area
+      // vector of the face, which is robust against nearly collinear vertices
+      double sum = 0;
+      for ( t = 0; t < n; t++ )
+        sum += orientation[t];
+
+      list.vertices.push_back( aa );
+      if ( sum < 0 )
+      {
+        for ( t = faceOffsets[f] + 1; t < faceOffsets[f + 1]; t++ )
+          list.vertices.push_back( faceVertices[t] );
+      }
+
+      else
+      {
+        for ( t = faceOffsets[f + 1] - 1; t > faceOffsets[f]; t-- )
+          list.vertices.push_back( faceVertices[t] );
+      }
+      list.offsets.push_back( list.vertices.size() );
+    }
+
+    else
+    {
+      for ( t = 0; t < n; t++ )
+      {
+        bb = faceVertices[faceOffsets[f] + 1 + t];
+        cc = faceVertices[faceOffsets[f] + 2 + t];
+
+        // Order the triangle so that its normal points away from the particle
+        bool away = orientation[t] < 0;
+        list.vertices.push_back( aa );
+        list.vertices.push_back( away ? bb : cc );
+        list.vertices.push_back( away ? cc : bb );
+        list.offsets.push_back( list.vertices.size() );
+      }
+    }
+  }
+}
+
+// Neighbour id of the face to the left of the `jj`th edge of vertex `ii`
+static inline int edgeNeighbour( voro::voronoicell&, int, int )
+{
+  return 0;
+}
+
+static inline int edgeNeighbour( voro::voronoicell_neighbor& vc, int ii, int jj )
+{
+  return vc.ne[ii][jj];
+}
+
+// `walkCell()` of either kind of cell
+template < class Cell >
+static void walkFaces( Cell& vc,
+                       double x, double y, double z,
+                       bool neighbours,
+                       CellMesh& mesh,
+                       const double* offsetMap )
+{
+  int ii, jj, kk, ll, mm, nn;
+
+  mesh.x = x;
+  mesh.y = y;
+  mesh.z = z;
+  mesh.faceVertices.clear();
+  mesh.faceOffsets.clear();
+  mesh.faceOffsets.push_back( 0 );
+  mesh.faceNeighbours.clear();
+  mesh.faceOrigins.clear();
+
+  // Store coordinates of each vertex. Each set of vertex coordinates is
+  // stored at every 3 elements in `vertices`
+  if ( offsetMap )
+  {
+    // voro++ stores the vertices at twice their offset
+    const double* m = offsetMap;
+    mesh.vertices.resize( 3 * vc.p );
+    for ( ii = 0; ii < vc.p; ii++ )
+    {
+      const double* offset = vc.pts + 3 * ii;
+      double* vertex = mesh.vertices.data() + 3 * ii;
+      vertex[0] = x + 0.5 * ( m[0] * offset[0] + m[1] * offset[1] + m[2] * offset[2] );
+      vertex[1] = y + 0.5 * ( m[3] * offset[0] + m[4] * offset[1] + m[5] * offset[2] );
+      vertex[2] = z + 0.5 * ( m[6] * offset[0] + m[7] * offset[1] + m[8] * offset[2] );
+    }
+  }
+  else
+    vc.vertices( x, y, z, mesh.vertices );
+
+  // Trace each face once. An edge is marked as visited by replacing its
+  // destination `kk` with `-1 - kk`. The control flow below is copied from
+  // voro++ since the API is hard to understand.
+  for ( ii = 1; ii < vc.p; ii++ )
+  {
+    for ( jj = 0; jj < vc.nu[ii]; jj++ )
+    {
+      kk = vc.ed[ii][jj];
+      if ( kk >= 0 )
+      {
+        if ( neighbours )
+          mesh.faceNeighbours.push_back( edgeNeighbour( vc, ii, jj ) );
+        vc.ed[ii][jj] = -1 - kk;
+        mesh.faceVertices.push_back( ii );
+        ll = vc.cycle_up( vc.ed[ii][vc.nu[ii] + jj], kk );
+        mm = vc.ed[kk][ll];
+        vc.ed[kk][ll] = -1 - mm;
+        while ( mm != ii )
+        {
+          mesh.faceVertices.push_back( kk );
+          nn = vc.cycle_up( vc.ed[kk][vc.nu[kk] + ll], mm );
+          kk = mm;
+          ll = nn;
+          mm = vc.ed[kk][ll];
+          vc.ed[kk][ll] = -1 - mm;
+        }
+        mesh.faceVertices.push_back( kk );
+        mesh.faceOffsets.push_back( mesh.faceVertices.size() );
+      }
+    }
+  }
+
+  // Restore the edges so that the cell can still be queried
+  for ( ii = 0; ii < vc.p; ii++ )
+  {
+    for ( jj = 0; jj < vc.nu[ii]; jj++ )
+    {
+      if ( vc.ed[ii][jj] < 0 )
+        vc.ed[ii][jj] = -1 - vc.ed[ii][jj];
+    }
+  }
+}
+
+void walkCell( voro::voronoicell& vc,
+               double x, double y, double z,
+               CellMesh& mesh,
+               const double* offsetMap )
+{
+  walkFaces( vc, x, y, z, false, mesh, offsetMap );
+}
+
+void walkCell( voro::voronoicell_neighbor& vc,
+               double x, double y, double z,
+               CellMesh& mesh,
+               const double* offsetMap )
+{
+  walkFaces( vc, x, y, z, true, mesh, offsetMap );
+}
@@ -0,0 +1,84 @@
+#ifndef CELLMESH_H
+#define CELLMESH_H
+
+#include <stddef.h>
+#include <vector>
+#include <voro++.hh>
+
+// Faces of a cell ready to be written. Each face is a loop of vertex indices
+// ordered so that the normal of the face points away from the particle. The
+// indices of face `f` are stored in `vertices` from `offsets[f]` up to (but not
+// including) `offsets[f + 1]`.
+struct FaceList
+{
+  std::vector< int > vertices;
+  std::vector< int > offsets;
+
+  // Scratch space of `CellMesh::orientedFaces()`: the fan triangles of one
+  // face as separate coordinate arrays, followed by their orientations
+  std::vector< double > fan;
+
+  // Number of faces
+  int faces() const { return int( offsets.size() ) - 1; }
+
+  // Bytes held by the list and its scratch space
+  size_t bytes() const
+  {
+    return ( vertices.capacity() + offsets.capacity() ) * sizeof( int )
+      + fan.capacity() * sizeof( double );
+  }
+};
+
+// Geometry of a computed voronoi cell. Each face is a loop of indices into the
+// vertices of the cell, in the order voro++ walks the edges of the face. The
+// indices of face `f` are stored in `faceVertices` from `faceOffsets[f]` up to
+// (but not including) `faceOffsets[f + 1]`.
+class CellMesh
+{
+public:
+
+  // Coordinates of the particle of the cell, from which the faces are
+  // oriented, or of another point inside the cell
+  double x, y, z;
+
+  // Coordinates of each vertex, stored at every 3 elements
+  std::vector< double > vertices;
+
+  std::vector< int > faceVertices;
+  std::vector< int > faceOffsets;
+
+  // Neighbour id of each face, if the cell was walked with its neighbours
+  std::vector< int > faceNeighbours;
+
+  // If not empty, a point behind each face (stored at every 3 elements) used
+  // instead of the particle to orient the face. Needed when the cell is not
+  // convex or does not contain its particle.
+  std::vector< double > faceOrigins;
+
+  // Number of faces
+  int faces() const { return int( faceOffsets.size() ) - 1; }
+
+  // Store the faces of the cell in `list`, oriented so that their normals
+  // point away from the particle (or from their origins). If `polygons` is false, each face is split
+  // into a fan of triangles around its first vertex and each triangle is
+  // oriented on its own.
+  void orientedFaces( bool polygons, FaceList& list ) const;
+
+};
+
+// Store the vertices and faces of the cell `vc` of the particle at (x, y, z)
+// in `mesh`. The edges of `vc` are left as they were found. If `offsetMap` is
+// not null, the offsets of the vertices from the particle are mapped by this
+// 3 by 3 matrix, stored by rows, as for cells computed in a transformed space.
+void walkCell( voro::voronoicell& vc,
+               double x, double y, double z,
+               CellMesh& mesh,
+               const double* offsetMap = nullptr );
+
+// Same as above, also storing the neighbour id of each face
+void walkCell( voro::voronoicell_neighbor& vc,
+               double x, double y, double z,
+               CellMesh& mesh,
+               const double* offsetMap = nullptr );
+
+#endif
@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <stdexcept>
+#include "cellStream.h"
+
+StreamFormat streamFormat( const std::string& name )
+{
+  if ( name == "wkt" )
+    return STREAM_WKT;
+  if ( name == "geojson" )
+    return STREAM_GEOJSON;
+  if ( name == "csv" )
+    return STREAM_CSV;
+
+  throw std::invalid_argument( "Invalid format: Value must be \"wkt\", \"geojson\" or \"csv\"." );
+}
+
+RecordWriter::RecordWriter( StreamFormat format, NumberFormat numbers, bool polygons )
+  : format( format ),
+    polygons( polygons ),
+    volumes( -1 ),
+    wktWriter( numbers ),
+    jsonWriter( numbers )
+{
+}
+
+std::string RecordWriter::header() const
+{
+  return format == STREAM_CSV ? "id,wkt,volume\n" : "";
+}
+
+void RecordWriter::append( size_t id, const CellMesh* mesh, double volume, std::string& out )
+{
+  std::string number = std::to_string( id + 1 );
+
+  if ( format == STREAM_WKT )
+  {
+    if ( mesh )
+    {
+      wktWriter.write( *mesh, polygons, text );
+      out += text;
+    }
+    else
+      out += WktWriter::empty();
+    out += '\n';
+  }
+
+  else if ( format == STREAM_GEOJSON )
+  {
+    out += "\x1e{\"type\":\"Feature\",\"id\":";
+    out += number;
+    out += ",\"geometry\":";
+    if ( mesh )
+    {
+      jsonWriter.append( *mesh, polygons, out );
+      out += ",\"properties\":{\"volume\":";
+      volumes.append( out, volume );
+      out += "}}\n";
+    }
+    else
+      out += "null,\"properties\":{\"volume\":null}}\n";
+  }
+
+  else
+  {
+    out += number;
+    if ( mesh )
+    {
+      wktWriter.write( *mesh, polygons, text );
+      out += ",\"";
+      out += text;
+      out += "\",";
+      volumes.append( out, volume );
+      out += '\n';
+    }
+    else
+      out += ",NA,NA\n";
+  }
+}
+
+ReorderBuffer::ReorderBuffer( std::FILE* file, size_t capacity )
+  : file( file ),
+    capacity( capacity )
+{
+  if ( !file )
+    throw std::invalid_argument( "Invalid file: The file is not open." );
+}
+
+void ReorderBuffer::write( size_t number, std::string& text )
+{
+  std::unique_lock< std::mutex > lock ( mutex );
+  turn.wait( lock, [&]()
+  {
+    return aborted || number == next || held + text.size() <= capacity;
+  } );
+
+  if ( aborted )
+    return;
+
+  held += text.size();
+  peak = std::max( peak, held );
+  pending[number].swap( text );
+  if ( writing )
+    return;
+
+  // Write the chunks that are ready, including those finished by other
+  // threads in the meantime
+  writing = true;
+  while ( !aborted && !pending.empty() && pending.begin()->first == next )
+  {
+    std::string chunk;
+    chunk.swap( pending.begin()->second );
+    pending.erase( pending.begin() );
+    held -= chunk.size();
+    next++;
+    turn.notify_all();
+
+    lock.unlock();
+    bool failed = std::fwrite( chunk.data(), 1, chunk.size(), file ) != chunk.size();
+    lock.lock();
+
+    if ( failed )
+    {
+      aborted = true;
+      writing = false;
+      turn.notify_all();
+      throw std::runtime_error( "Cannot write the file." );
+    }
+    written += chunk.size();
+  }
+  writing = false;
+}
+
+void ReorderBuffer::abort()
+{
+  std::lock_guard< std::mutex > lock ( mutex );
+  aborted = true;
+  pending.clear();
+  held = 0;
+  turn.notify_all();
+}
+
+void ReorderBuffer::finish( size_t count )
+{
+  std::lock_guard< std::mutex > lock ( mutex );
+  if ( aborted || next != count )
+    throw std::runtime_error( "Cannot write the file: Records are missing." );
+
+  if ( std::fflush( file ) != 0 || std::ferror( file ) )
+    throw std::runtime_error( "Cannot write the file." );
+}
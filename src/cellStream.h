@@ -0,0 +1,124 @@
+#ifndef CELLSTREAM_H
+#define CELLSTREAM_H
+
+#include <condition_variable>
+#include <cstdio>
+#include <map>
+#include <mutex>
+#include <string>
+
+#include "cellMesh.h"
+#include "geojson.h"
+#include "numberFormat.h"
+#include "wkt.h"
+
+// Formats of the files written by `streamOutput()`, one record per point in
+// the order of the points
+enum StreamFormat
+{
+  // Well-known text of one cell per line, or POLYHEDRALSURFACE EMPTY
+  STREAM_WKT,
+
+  // GeoJSON text sequence (RFC 8142) of one Feature per cell, whose id is
+  // the 1-based point number, whose geometry is null if the cell was not
+  // computed and whose properties hold the volume
+  STREAM_GEOJSON,
+
+  // CSV lines id,wkt,volume after a header line, with 1-based point numbers,
+  // the text quoted and NA for the cells that were not computed
+  STREAM_CSV
+};
+
+// Format named "wkt", "geojson" or "csv"
+StreamFormat streamFormat( const std::string& name );
+
+// File to which `streamOutput()` writes the cells
+struct CellStream
+{
+  std::FILE* file = nullptr;
+  StreamFormat format = STREAM_WKT;
+
+  // Bytes of finished records that may be held back while waiting for
+  // earlier records, which bounds the memory of the output
+  size_t bufferBytes = size_t( 64 ) << 20;
+};
+
+// Writes the record of each cell in one stream format. Coordinates are
+// written with the number format of the text, volumes in the shortest form
+// that reads back to the same number. A writer holds scratch space, so each
+// thread needs its own.
+class RecordWriter
+{
+public:
+
+  RecordWriter( StreamFormat format, NumberFormat numbers, bool polygons );
+
+  // Text written before the first record
+  std::string header() const;
+
+  // Append the record of point `id` (0-based) to `out`, with the cell `mesh`
+  // and its volume, or of a cell that was not computed if `mesh` is null
+  void append( size_t id, const CellMesh* mesh, double volume, std::string& out );
+
+  // Bytes of scratch space held by the writer
+  size_t scratchBytes() const
+  {
+    return wktWriter.scratchBytes() + jsonWriter.scratchBytes() + text.capacity();
+  }
+
+private:
+
+  StreamFormat format;
+  bool polygons;
+  NumberFormat volumes;
+  WktWriter wktWriter;
+  GeoJsonWriter jsonWriter;
+  std::string text;
+
+};
+
+// Writes numbered chunks of text to a file in the order of their numbers,
+// whatever the order in which threads finish them. A chunk finished ahead of
+// its turn is held until the chunks before it are written. Once the held
+// chunks would exceed `capacity` bytes, a thread finishing a chunk ahead of
+// its turn waits, so the memory held is bounded however unevenly the chunks
+// take. The thread holding the next chunk never waits, so this cannot
+// deadlock as long as every chunk is eventually written or the buffer is
+// aborted. Chunks are written outside of the lock, by one thread at a time.
+class ReorderBuffer
+{
+public:
+
+  ReorderBuffer( std::FILE* file, size_t capacity );
+
+  // Write chunk `number`, counted from 0, whose text is taken from `text`,
+  // which is left empty. Throws if the file cannot be written.
+  void write( size_t number, std::string& text );
+
+  // Stop writing and release the waiting threads, e.g. when a thread failed.
+  // Chunks written after this are dropped.
+  void abort();
+
+  // Flush the file after the last chunk. Throws if not all chunks up to
+  // `count` were written or if the file cannot be written.
+  void finish( size_t count );
+
+  // Bytes written so far
+  size_t bytes() const { return written; }
+
+  // Largest number of bytes held at once
+  size_t peakBytes() const { return peak; }
+
+private:
+
+  std::FILE* file;
+  size_t capacity;
+  size_t next = 0, held = 0, peak = 0, written = 0;
+  bool writing = false, aborted = false;
+  std::map< size_t, std::string > pending;
+  std::mutex mutex;
+  std::condition_variable turn;
+
+};
+
+#endif
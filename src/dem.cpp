@@ -0,0 +1,251 @@
+#include <algorithm>
+#include <math.h>
+#include <stdexcept>
+#include "dem.h"
+
+// Neighbour id of the faces of the pieces on the planes that split a cell
+// into columns. Such faces are shared by two pieces and are not part of the
+// surface of the clipped cell.
+static const int columnId = -1000001;
+
+void checkDem( const Dem& dem )
+{
+  if ( dem.nx < 2 || dem.ny < 2 || dem.z.size() != size_t( dem.nx ) * dem.ny )
+    throw std::invalid_argument( "Invalid dem: Grid must have at least 2 by 2 nodes." );
+
+  if ( !isfinite( dem.x0 ) || !isfinite( dem.y0 ) ||
+       !( dem.dx > 0 ) || !( dem.dy > 0 ) || !isfinite( dem.dx ) || !isfinite( dem.dy ) )
+    throw std::invalid_argument( "Invalid dem: Grid spacing must be positive." );
+
+  for ( double z : dem.z )
+  {
+    if ( !isfinite( z ) )
+      throw std::invalid_argument( "Invalid dem: Elevations must be finite." );
+  }
+}
+
+DemClipper::DemClipper( const Dem& dem ) : dem( dem )
+{
+  low = *std::min_element( dem.z.begin(), dem.z.end() );
+  high = *std::max_element( dem.z.begin(), dem.z.end() );
+}
+
+TerrainSide DemClipper::side( voro::voronoicell& vc, double x, double y, double z )
+{
+  particle[0] = x;
+  particle[1] = y;
+  particle[2] = z;
+
+  // Vertices are stored at twice their position relative to the particle
+  for ( int a = 0; a < 3; a++ )
+    cellLow[a] = cellHigh[a] = particle[a] + 0.5 * vc.pts[a];
+
+  for ( int v = 1; v < vc.p; v++ )
+  {
+    for ( int a = 0; a < 3; a++ )
+    {
+      double position = particle[a] + 0.5 * vc.pts[3 * v + a];
+      cellLow[a] = std::min( cellLow[a], position );
+      cellHigh[a] = std::max( cellHigh[a], position );
+    }
+  }
+
+  if ( cellHigh[2] <= low )
+    return BELOW_TERRAIN;
+
+  double xEnd = dem.x0 + ( dem.nx - 1 ) * dem.dx;
+  double yEnd = dem.y0 + ( dem.ny - 1 ) * dem.dy;
+  if ( cellHigh[0] <= dem.x0 || cellLow[0] >= xEnd ||
+       cellHigh[1] <= dem.y0 || cellLow[1] >= yEnd )
+    return BELOW_TERRAIN;
+
+  // Grid squares under the cell
+  i0 = std::max( 0, int( floor( ( cellLow[0] - dem.x0 ) / dem.dx ) ) );
+  i1 = std::min( dem.nx - 2, int( floor( ( cellHigh[0] - dem.x0 ) / dem.dx ) ) );
+  j0 = std::max( 0, int( floor( ( cellLow[1] - dem.y0 ) / dem.dy ) ) );
+  j1 = std::min( dem.ny - 2, int( floor( ( cellHigh[1] - dem.y0 ) / dem.dy ) ) );
+
+  double nodeLow = elevation( i0, j0 ), nodeHigh = nodeLow;
+  for ( int j = j0; j <= j1 + 1; j++ )
+  {
+    for ( int i = i0; i <= i1 + 1; i++ )
+    {
+      nodeLow = std::min( nodeLow, elevation( i, j ) );
+      nodeHigh = std::max( nodeHigh, elevation( i, j ) );
+    }
+  }
+
+  if ( cellHigh[2] <= nodeLow )
+    return BELOW_TERRAIN;
+
+  bool beyond = cellLow[0] < dem.x0 || cellHigh[0] > xEnd ||
+    cellLow[1] < dem.y0 || cellHigh[1] > yEnd;
+  if ( !beyond && cellLow[2] >= nodeHigh )
+    return ABOVE_TERRAIN;
+
+  return CROSSES_TERRAIN;
+}
+
+bool DemClipper::cut( voro::voronoicell_neighbor& c, double a, double b, double cz,
+                      double d, int id )
+{
+  double length = sqrt( a * a + b * b + cz * cz );
+  a /= length;
+  b /= length;
+  cz /= length;
+  d /= length;
+
+  double offset = d - a * particle[0] - b * particle[1] - cz * particle[2];
+  return c.nplane( a, b, cz, 2 * offset, id );
+}
+
+double DemClipper::addPiece( voro::voronoicell_neighbor& c, CellMesh* mesh )
+{
+  if ( !mesh )
+    return c.volume();
+
+  walkCell( c, particle[0], particle[1], particle[2], pieceMesh );
+
+  // The centroid of the vertices is inside the convex piece and behind each
+  // of its faces
+  double centroid[3] = { 0, 0, 0 };
+  int vertices = pieceMesh.vertices.size() / 3;
+  for ( int v = 0; v < vertices; v++ )
+  {
+    for ( int a = 0; a < 3; a++ )
+      centroid[a] += pieceMesh.vertices[3 * v + a] / vertices;
+  }
+
+  int base = mesh->vertices.size() / 3;
+  mesh->vertices.insert( mesh->vertices.end(),
+                         pieceMesh.vertices.begin(), pieceMesh.vertices.end() );
+
+  for ( int f = 0; f < pieceMesh.faces(); f++ )
+  {
+    if ( pieceMesh.faceNeighbours[f] == columnId )
+      continue;
+
+    for ( int i = pieceMesh.faceOffsets[f]; i < pieceMesh.faceOffsets[f + 1]; i++ )
+      mesh->faceVertices.push_back( base + pieceMesh.faceVertices[i] );
+    mesh->faceOffsets.push_back( mesh->faceVertices.size() );
+    mesh->faceNeighbours.push_back( pieceMesh.faceNeighbours[f] );
+    mesh->faceOrigins.insert( mesh->faceOrigins.end(), centroid, centroid + 3 );
+  }
+
+  return c.volume();
+}
+
+double DemClipper::clip( voro::voronoicell& vc, double x, double y, double z,
+                         CellMesh* mesh )
+{
+  double volume = 0;
+  double xEnd = dem.x0 + ( dem.nx - 1 ) * dem.dx;
+  double yEnd = dem.y0 + ( dem.ny - 1 ) * dem.dy;
+
+  if ( mesh )
+  {
+    mesh->x = x;
+    mesh->y = y;
+    mesh->z = z;
+    mesh->vertices.clear();
+    mesh->faceVertices.clear();
+    mesh->faceOffsets.assign( 1, 0 );
+    mesh->faceNeighbours.clear();
+    mesh->faceOrigins.clear();
+  }
+
+  cell = vc;
+
+  // Parts beyond the grid are kept whole
+  if ( cellLow[0] < dem.x0 )
+  {
+    piece = cell;
+    if ( cut( piece, 1, 0, 0, dem.x0, columnId ) )
+      volume += addPiece( piece, mesh );
+  }
+
+  if ( cellHigh[0] > xEnd )
+  {
+    piece = cell;
+    if ( cut( piece, -1, 0, 0, -xEnd, columnId ) )
+      volume += addPiece( piece, mesh );
+  }
+
+  if ( !cut( cell, -1, 0, 0, -dem.x0, columnId ) || !cut( cell, 1, 0, 0, xEnd, columnId ) )
+    return volume;
+
+  if ( cellLow[1] < dem.y0 )
+  {
+    piece = cell;
+    if ( cut( piece, 0, 1, 0, dem.y0, columnId ) )
+      volume += addPiece( piece, mesh );
+  }
+
+  if ( cellHigh[1] > yEnd )
+  {
+    piece = cell;
+    if ( cut( piece, 0, -1, 0, -yEnd, columnId ) )
+      volume += addPiece( piece, mesh );
+  }
+
+  // Split the part over the grid into rows, squares and triangles
+  for ( int j = j0; j <= j1; j++ )
+  {
+    double yj = dem.y0 + j * dem.dy;
+    strip = cell;
+    if ( !cut( strip, 0, -1, 0, -yj, columnId ) ||
+         !cut( strip, 0, 1, 0, yj + dem.dy, columnId ) )
+      continue;
+
+    for ( int i = i0; i <= i1; i++ )
+    {
+      double xi = dem.x0 + i * dem.dx;
+      square = strip;
+      if ( !cut( square, -1, 0, 0, -xi, columnId ) ||
+           !cut( square, 1, 0, 0, xi + dem.dx, columnId ) )
+        continue;
+
+      double z00 = elevation( i, j ), z10 = elevation( i + 1, j );
+      double z01 = elevation( i, j + 1 ), z11 = elevation( i + 1, j + 1 );
+      double nodeLow = std::min( std::min( z00, z10 ), std::min( z01, z11 ) );
+      double nodeHigh = std::max( std::max( z00, z10 ), std::max( z01, z11 ) );
+
+      double squareLow = square.pts[2], squareHigh = square.pts[2];
+      for ( int v = 1; v < square.p; v++ )
+      {
+        squareLow = std::min( squareLow, square.pts[3 * v + 2] );
+        squareHigh = std::max( squareHigh, square.pts[3 * v + 2] );
+      }
+      squareLow = z + 0.5 * squareLow;
+      squareHigh = z + 0.5 * squareHigh;
+
+      if ( squareHigh <= nodeLow )
+      {
+        volume += addPiece( square, mesh );
+        continue;
+      }
+
+      if ( squareLow >= nodeHigh )
+        continue;
+
+      // The triangle below the diagonal, through the nodes (i, j),
+      // (i + 1, j) and (i + 1, j + 1), and the one above it, through (i, j),
+      // (i, j + 1) and (i + 1, j + 1)
+      for ( int upper = 0; upper < 2; upper++ )
+      {
+        double sign = upper ? -1 : 1;
+        piece = square;
+        if ( !cut( piece, -sign / dem.dx, sign / dem.dy, 0,
+                   sign * ( yj / dem.dy - xi / dem.dx ), columnId ) )
+          continue;
+
+        double gx = upper ? ( z11 - z01 ) / dem.dx : ( z10 - z00 ) / dem.dx;
+        double gy = upper ? ( z01 - z00 ) / dem.dy : ( z11 - z10 ) / dem.dy;
+        if ( cut( piece, -gx, -gy, 1, z00 - gx * xi - gy * yj, terrainId ) )
+          volume += addPiece( piece, mesh );
+      }
+    }
+  }
+
+  return volume;
+}
@@ -0,0 +1,86 @@
+#ifndef DEM_H
+#define DEM_H
+
+#include <vector>
+#include <voro++.hh>
+
+#include "cellMesh.h"
+
+// Digital elevation model on a regular grid of `nx` by `ny` nodes. The node
+// (i, j) is at (x0 + i dx, y0 + j dy) with the elevation z[i + nx j]. The
+// terrain is the surface through the nodes made of two triangles per grid
+// square, split along the diagonal from (i, j) to (i + 1, j + 1).
+struct Dem
+{
+  double x0 = 0, y0 = 0, dx = 1, dy = 1;
+  int nx = 0, ny = 0;
+  std::vector< double > z;
+
+  bool empty() const { return z.empty(); }
+};
+
+// Neighbour id of the faces of clipped cells on the terrain
+const int terrainId = -1000000;
+
+// Check that the grid has at least 2 by 2 nodes, positive spacing and
+// finite elevations
+void checkDem( const Dem& dem );
+
+// Where a cell is with respect to the terrain
+enum TerrainSide
+{
+  BELOW_TERRAIN,
+  ABOVE_TERRAIN,
+  CROSSES_TERRAIN
+};
+
+// Clips cells by the terrain, keeping their part below it. A clipped cell is
+// the union of convex pieces, one per part of the cell over a triangle of the
+// terrain, each cut by the plane of its triangle. Parts of the cell beyond
+// the grid are kept whole. Each thread needs its own clipper.
+class DemClipper
+{
+public:
+  explicit DemClipper( const Dem& dem );
+
+  // Side of the terrain of the cell `vc` of the particle at (x, y, z). Cells
+  // whose highest vertex is below the lowest node of the whole grid, or of
+  // the nodes under the cell, are rejected as below the terrain without
+  // being cut.
+  TerrainSide side( voro::voronoicell& vc, double x, double y, double z );
+
+  // Clip the cell `vc` of the particle at (x, y, z), for which `side()`
+  // returned CROSSES_TERRAIN, and return the volume of its part below the
+  // terrain. If `mesh` is not null, the faces of that part are stored in it,
+  // each with the centroid of its piece as origin.
+  double clip( voro::voronoicell& vc, double x, double y, double z,
+               CellMesh* mesh );
+
+private:
+  const Dem& dem;
+  double low, high;
+
+  // Bounds of the cell and of the grid nodes under it, set by `side()`
+  double cellLow[3], cellHigh[3];
+  int i0, i1, j0, j1;
+
+  // Scratch space
+  voro::voronoicell_neighbor cell, strip, square, piece;
+  CellMesh pieceMesh;
+
+  double elevation( int i, int j ) const { return dem.z[i + dem.nx * j]; }
+
+  // Keep the part of `c` where a x + b y + cz z < d and tag the new face
+  // with `id`. Returns false if nothing is left.
+  bool cut( voro::voronoicell_neighbor& c, double a, double b, double cz,
+            double d, int id );
+
+  // Add the piece `c`, whose part below the terrain is all of it, and return
+  // its volume
+  double addPiece( voro::voronoicell_neighbor& c, CellMesh* mesh );
+
+  // Coordinates of the particle of the cell
+  double particle[3];
+};
+
+#endif
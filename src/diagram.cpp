@@ -0,0 +1,837 @@
+#include <algorithm>
+#include <map>
+#include <math.h>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include "diagram.h"
+#include "vec3.h"
+#include "wkb.h"
+#include "wkt.h"
+
+// Area of face `f` of `mesh`, from the sum of the normals of its fan
+// triangles
+static double faceArea( const CellMesh& mesh, int f )
+{
+  const double* v = mesh.vertices.data();
+  const int* loop = mesh.faceVertices.data();
+  const Vec3 pA = Vec3::at( v + 3 * loop[mesh.faceOffsets[f]] );
+  Vec3 normal;
+
+  for ( int t = mesh.faceOffsets[f] + 1; t < mesh.faceOffsets[f + 1] - 1; t++ )
+  {
+    normal = normal + cross( Vec3::at( v + 3 * loop[t] ) - pA,
+                             Vec3::at( v + 3 * loop[t + 1] ) - pA );
+  }
+
+  return 0.5 * sqrt( dot( normal, normal ) );
+}
+
+// Map `vertex` to the space of the cells by `anisotropy`, unless null
+static void cellSpace( const Anisotropy* anisotropy, const double* vertex, double* at )
+{
+  if ( anisotropy )
+    anisotropy->forward( vertex[0], vertex[1], vertex[2], at );
+  else
+    std::copy( vertex, vertex + 3, at );
+}
+
+static double squaredDistance( const double* a, const double* b )
+{
+  return ( a[0] - b[0] ) * ( a[0] - b[0] ) + ( a[1] - b[1] ) * ( a[1] - b[1] )
+    + ( a[2] - b[2] ) * ( a[2] - b[2] );
+}
+
+Diagram::Diagram( const Points& points, const CellOptions& options )
+  : x( points.x, points.x + points.n ),
+    y( points.y, points.y + points.n ),
+    z( points.z, points.z + points.n ),
+    alive( points.n, 1 ),
+    settings( options )
+{
+  if ( !options.dem.empty() )
+    throw std::invalid_argument( "Invalid dem: A diagram cannot be clipped by a terrain." );
+
+  if ( points.radius )
+    radius.assign( points.radius, points.radius + points.n );
+
+  settings.output = OUTPUT_CELLS;
+  settings.profile = false;
+
+  Points copy { x.data(), y.data(), z.data(), x.size(), nullptr,
+                radius.empty() ? nullptr : radius.data() };
+  computeOutput( copy, settings, cells );
+
+  // Container of the points over the container of the cells, in the space
+  // where the cells were computed
+  if ( !settings.anisotropy.empty() )
+    anisotropy.reset( new Anisotropy( settings.anisotropy ) );
+
+  Points source = sourcePoints();
+  ContainerGrid grid = containerGrid( source, settings.containerRatio, settings.grid );
+  std::copy( grid.low, grid.low + 3, low );
+  std::copy( grid.high, grid.high + 3, high );
+  locator.reset( new PointLocator( source, settings.grid, low, high ) );
+}
+
+Points Diagram::sourcePoints() const
+{
+  return Points { x.data(), y.data(), z.data(), x.size(), anisotropy.get() };
+}
+
+void Diagram::mesh( size_t id, CellMesh& mesh ) const
+{
+  const MeshSlot& slot = cells.slots[id];
+  const MeshChunk& chunk = cells.chunks[slot.thread];
+  const double* vertices = chunk.vertices.data() + slot.vertex;
+
+  mesh.vertices.assign( vertices, vertices + 3 * slot.vertices );
+  mesh.faceVertices.assign( chunk.faces.begin() + slot.face,
+                            chunk.faces.begin() + slot.face + slot.indices );
+  mesh.faceNeighbours.assign( chunk.faceNeighbours.begin() + slot.faceSize,
+                              chunk.faceNeighbours.begin() + slot.faceSize + slot.faces );
+  mesh.faceOrigins.clear();
+  mesh.faceOffsets.assign( 1, 0 );
+  for ( int f = 0; f < slot.faces; f++ )
+    mesh.faceOffsets.push_back( mesh.faceOffsets.back() + chunk.faceSizes[slot.faceSize + f] );
+
+  // The cell is convex, so the centroid of its vertices is inside it and
+  // behind each of its faces
+  double centroid[3] = { 0, 0, 0 };
+  for ( int v = 0; v < slot.vertices; v++ )
+  {
+    for ( int a = 0; a < 3; a++ )
+      centroid[a] += vertices[3 * v + a] / slot.vertices;
+  }
+
+  mesh.x = centroid[0];
+  mesh.y = centroid[1];
+  mesh.z = centroid[2];
+}
+
+void Diagram::write( const std::vector< size_t >& ids,
+                     OutputFormat format,
+                     bool polygons,
+                     int precision,
+                     int threads,
+                     CellOutput& output ) const
+{
+  if ( format == OUTPUT_BLOCKS || format == OUTPUT_CELLS )
+    throw std::invalid_argument(
+      "Invalid output: Value must be \"wkt\", \"wkb\", \"mesh\", \"volume\" or \"adjacency\"." );
+
+  if ( threads < 1 )
+    throw std::invalid_argument( "Invalid threads: Value must not be less than 1." );
+
+  if ( precision > 20 )
+    throw std::invalid_argument( "Invalid precision: Value must not be greater than 20." );
+
+  for ( size_t id : ids )
+  {
+    if ( id >= size() )
+      throw std::invalid_argument( "Invalid ids: Values must be indices of the points." );
+  }
+
+  size_t n = ids.size();
+  output = CellOutput();
+  output.format = format;
+  output.computed.assign( n, 0 );
+  output.wkt.resize( format == OUTPUT_WKT ? n : 0 );
+  output.wkb.resize( format == OUTPUT_WKB ? n : 0 );
+  output.chunks.resize( format == OUTPUT_MESH ? threads : 0 );
+  output.slots.resize( format == OUTPUT_MESH ? n : 0 );
+  output.volume.assign( format == OUTPUT_VOLUME ? n : 0, NAN );
+  output.adjacency.resize( format == OUTPUT_ADJACENCY ? threads : 0 );
+  output.adjacencySlots.resize( format == OUTPUT_ADJACENCY ? n : 0 );
+
+  std::vector< WktWriter > writers ( format == OUTPUT_WKT ? threads : 0,
+                                     WktWriter( NumberFormat( precision ) ) );
+  CellWorkers workers = cellWorkers( threads );
+
+  parallelFor( int( n ), threads, [&]( int item, int thread )
+  {
+    size_t id = ids[item];
+    if ( !computed( id ) )
+      return;
+
+    CellWorker& worker = *workers[thread];
+    output.computed[item] = 1;
+
+    if ( format == OUTPUT_VOLUME )
+    {
+      output.volume[item] = cells.volume[id];
+      return;
+    }
+
+    mesh( id, worker.mesh );
+
+    if ( format == OUTPUT_ADJACENCY )
+    {
+      AdjacencyChunk& chunk = output.adjacency[thread];
+      AdjacencySlot& slot = output.adjacencySlots[item];
+      slot.thread = thread;
+      slot.face = chunk.neighbours.size();
+      slot.faces = worker.mesh.faces();
+
+      for ( int f = 0; f < slot.faces; f++ )
+      {
+        chunk.neighbours.push_back( worker.mesh.faceNeighbours[f] );
+        chunk.areas.push_back( faceArea( worker.mesh, f ) );
+      }
+    }
+
+    else if ( format == OUTPUT_WKT )
+      writers[thread].write( worker.mesh, polygons, output.wkt[item] );
+
+    else if ( format == OUTPUT_WKB )
+      cellWkb( worker.mesh, polygons, worker.faces, output.wkb[item] );
+
+    else
+    {
+      worker.mesh.orientedFaces( polygons, worker.faces );
+      appendFaces( worker.mesh, worker.faces, thread,
+                   output.chunks[thread], output.slots[item] );
+    }
+  } );
+}
+
+void Diagram::locate( const Points& queries,
+                      int threads,
+                      std::vector< int >& index,
+                      std::vector< double >& distance )
+{
+  if ( !radius.empty() )
+    throw std::invalid_argument( "Invalid diagram: Queries cannot be located in a power diagram." );
+
+  Points mapped = queries;
+  mapped.anisotropy = anisotropy.get();
+
+  // Points that are not deleted
+  Points live = sourcePoints();
+  std::vector< double > liveX, liveY, liveZ;
+  std::vector< size_t > liveIds;
+  if ( std::find( alive.begin(), alive.end(), 0 ) != alive.end() )
+  {
+    for ( size_t id = 0; id < size(); id++ )
+    {
+      if ( !alive[id] )
+        continue;
+      liveX.push_back( x[id] );
+      liveY.push_back( y[id] );
+      liveZ.push_back( z[id] );
+      liveIds.push_back( id );
+    }
+    live = Points { liveX.data(), liveY.data(), liveZ.data(), liveIds.size(), anisotropy.get() };
+  }
+
+  if ( !locator )
+    locator.reset( new PointLocator( live, settings.grid, low, high ) );
+
+  if ( locator->covers( mapped ) )
+    locator->locate( mapped, threads, index, distance );
+  else
+    locatePoints( live, mapped, settings.grid, threads, index, distance );
+
+  for ( int& located : index )
+  {
+    if ( located >= 0 && !liveIds.empty() )
+      located = int( liveIds[located] );
+  }
+}
+
+void Diagram::position( size_t id, double* at ) const
+{
+  sourcePoints().at( id, at );
+}
+
+double Diagram::power( const double* at, size_t id ) const
+{
+  double point[3];
+  position( id, point );
+  double distance = squaredDistance( at, point );
+  return radius.empty() ? distance : distance - radius[id] * radius[id];
+}
+
+bool Diagram::cuts( size_t id, const double* at, double radius2 ) const
+{
+  if ( !computed( id ) )
+    return false;
+
+  const MeshSlot& slot = cells.slots[id];
+  const double* vertices = cells.chunks[slot.thread].vertices.data() + slot.vertex;
+  double point[3], vertex[3];
+  double own = radius.empty() ? 0 : radius[id] * radius[id];
+  position( id, point );
+
+  for ( int v = 0; v < slot.vertices; v++ )
+  {
+    cellSpace( anisotropy.get(), vertices + 3 * v, vertex );
+    if ( squaredDistance( vertex, at ) - radius2 < squaredDistance( vertex, point ) - own )
+      return true;
+  }
+
+  return false;
+}
+
+size_t Diagram::owner( const double* at ) const
+{
+  size_t n = size(), best = n;
+  double nearest = INFINITY;
+
+  // Nearest of about a thousand points, or of all points if none of them
+  // has a cell
+  auto sample = [&]( size_t step )
+  {
+    for ( size_t id = 0; id < n; id += step )
+    {
+      if ( !computed( id ) )
+        continue;
+
+      double distance = power( at, id );
+      if ( distance < nearest )
+      {
+        nearest = distance;
+        best = id;
+      }
+    }
+  };
+
+  sample( std::max< size_t >( 1, n / 1024 ) );
+  if ( best == n )
+    sample( 1 );
+
+  // Walk to the nearest neighbour until no neighbour is nearer
+  size_t current = n;
+  while ( best != current )
+  {
+    current = best;
+    const MeshSlot& slot = cells.slots[current];
+    const int* neighbours = cells.chunks[slot.thread].faceNeighbours.data() + slot.faceSize;
+
+    for ( int f = 0; f < slot.faces; f++ )
+    {
+      if ( neighbours[f] < 0 || !computed( neighbours[f] ) )
+        continue;
+
+      double distance = power( at, neighbours[f] );
+      if ( distance < nearest )
+      {
+        nearest = distance;
+        best = neighbours[f];
+      }
+    }
+  }
+
+  return best;
+}
+
+void Diagram::addSpheres( size_t id,
+                          const std::vector< size_t >& owners,
+                          double maxRadius,
+                          std::vector< double >& spheres ) const
+{
+  if ( !computed( id ) )
+    return;
+
+  const MeshSlot& slot = cells.slots[id];
+  const double* vertices = cells.chunks[slot.thread].vertices.data() + slot.vertex;
+  double vertex[3];
+
+  for ( int v = 0; v < slot.vertices; v++ )
+  {
+    cellSpace( anisotropy.get(), vertices + 3 * v, vertex );
+
+    // A point cuts the cell of an owner at the vertex if its power distance
+    // is less than that of the owner
+    double reach = 0;
+    for ( size_t owner : owners )
+      reach = std::max( reach, power( vertex, owner ) );
+
+    spheres.insert( spheres.end(), vertex, vertex + 3 );
+    spheres.push_back( reach + maxRadius * maxRadius );
+  }
+}
+
+void Diagram::recompute( std::vector< size_t >& ids,
+                         const std::vector< double >& spheres,
+                         int threads,
+                         const std::map< size_t, std::vector< size_t > >* freed )
+{
+  if ( ids.empty() )
+    return;
+
+  // Box of the spheres and of the points, within the container of the cells
+  double boxLow[3] = { INFINITY, INFINITY, INFINITY };
+  double boxHigh[3] = { -INFINITY, -INFINITY, -INFINITY };
+  for ( size_t s = 0; s < spheres.size(); s += 4 )
+  {
+    double reach = sqrt( spheres[s + 3] );
+    for ( int a = 0; a < 3; a++ )
+    {
+      boxLow[a] = std::min( boxLow[a], spheres[s + a] - reach );
+      boxHigh[a] = std::max( boxHigh[a], spheres[s + a] + reach );
+    }
+  }
+
+  double at[3];
+  for ( size_t id : ids )
+  {
+    position( id, at );
+    for ( int a = 0; a < 3; a++ )
+    {
+      boxLow[a] = std::min( boxLow[a], at[a] );
+      boxHigh[a] = std::max( boxHigh[a], at[a] );
+    }
+  }
+
+  // The sides of the box within the container are moved out slightly, since
+  // voro++ leaves out points on the upper bounds
+  CellOptions options = settings;
+  options.threads = threads;
+  options.grid.bounded = true;
+  std::fill( options.grid.blocks, options.grid.blocks + 3, 0 );
+  for ( int a = 0; a < 3; a++ )
+  {
+    options.grid.low[a] = std::max( boxLow[a], low[a] );
+    options.grid.high[a] = boxHigh[a] < high[a]
+      ? std::min( high[a], boxHigh[a] + 1e-9 * ( high[a] - low[a] ) )
+      : high[a];
+  }
+
+  // Points in the box
+  std::vector< size_t > members;
+  std::vector< double > localX, localY, localZ, localRadius;
+  for ( size_t id = 0; id < size(); id++ )
+  {
+    position( id, at );
+    if ( !alive[id] ||
+         !( at[0] >= options.grid.low[0] && at[0] < options.grid.high[0] &&
+            at[1] >= options.grid.low[1] && at[1] < options.grid.high[1] &&
+            at[2] >= options.grid.low[2] && at[2] < options.grid.high[2] ) )
+      continue;
+
+    members.push_back( id );
+    localX.push_back( x[id] );
+    localY.push_back( y[id] );
+    localZ.push_back( z[id] );
+    if ( !radius.empty() )
+      localRadius.push_back( radius[id] );
+  }
+
+  Points local { localX.data(), localY.data(), localZ.data(), members.size(), nullptr,
+                 radius.empty() ? nullptr : localRadius.data() };
+  CellOutput output;
+  computeOutput( local, options, output );
+
+  // Points without a cell, e.g. hidden by a larger radius, whose new cell
+  // lies in the cells of the deleted points. A cell computed from the points
+  // of the container is exact there, and reaches out of them only where
+  // points beyond the container were left out, so it is tested at the mean
+  // of its vertices, which lies within it: the point is in the cell of a
+  // deleted point if that point is nearer in the power distance than the
+  // points it had faces with.
+  std::vector< size_t > uncovered;
+  for ( size_t m = 0; freed && m < members.size(); m++ )
+  {
+    size_t id = members[m];
+    if ( computed( id ) || !output.computed[m] ||
+         std::binary_search( ids.begin(), ids.end(), id ) )
+      continue;
+
+    const MeshSlot& slot = output.slots[m];
+    const double* vertices = output.chunks[slot.thread].vertices.data() + slot.vertex;
+    double mean[3] = { 0, 0, 0 };
+    for ( int v = 0; v < slot.vertices; v++ )
+    {
+      for ( int a = 0; a < 3; a++ )
+        mean[a] += vertices[3 * v + a] / slot.vertices;
+    }
+    cellSpace( anisotropy.get(), mean, at );
+
+    for ( const std::pair< const size_t, std::vector< size_t > >& cell : *freed )
+    {
+      double distance = power( at, cell.first );
+      bool inside = true;
+      for ( size_t neighbour : cell.second )
+        inside = inside && distance <= power( at, neighbour );
+
+      if ( inside )
+      {
+        uncovered.push_back( id );
+        break;
+      }
+    }
+  }
+
+  if ( !uncovered.empty() )
+  {
+    size_t middle = ids.size();
+    ids.insert( ids.end(), uncovered.begin(), uncovered.end() );
+    std::inplace_merge( ids.begin(), ids.begin() + middle, ids.end() );
+  }
+
+  for ( size_t id : ids )
+  {
+    auto member = std::lower_bound( members.begin(), members.end(), id );
+    if ( member != members.end() && *member == id )
+      storeCell( id, &output, member - members.begin(), members );
+    else
+      storeCell( id, nullptr, 0, members );
+  }
+
+  size_t vertices = 0;
+  for ( const MeshChunk& chunk : cells.chunks )
+    vertices += chunk.vertices.size();
+  if ( 2 * staleVertices > vertices )
+    compact();
+}
+
+void Diagram::storeCell( size_t id,
+                         const CellOutput* output,
+                         size_t local,
+                         const std::vector< size_t >& members )
+{
+  if ( computed( id ) )
+    staleVertices += 3 * cells.slots[id].vertices;
+
+  cells.slots[id] = MeshSlot();
+  cells.computed[id] = 0;
+  cells.volume[id] = NAN;
+  if ( !output || !output->computed[local] )
+    return;
+
+  const MeshSlot& from = output->slots[local];
+  const MeshChunk& source = output->chunks[from.thread];
+  MeshChunk& chunk = cells.chunks[0];
+  MeshSlot& slot = cells.slots[id];
+
+  slot = from;
+  slot.thread = 0;
+  slot.vertex = chunk.vertices.size();
+  slot.face = chunk.faces.size();
+  slot.faceSize = chunk.faceSizes.size();
+
+  chunk.vertices.insert( chunk.vertices.end(),
+                         source.vertices.begin() + from.vertex,
+                         source.vertices.begin() + from.vertex + 3 * from.vertices );
+  chunk.faces.insert( chunk.faces.end(),
+                      source.faces.begin() + from.face,
+                      source.faces.begin() + from.face + from.indices );
+  chunk.faceSizes.insert( chunk.faceSizes.end(),
+                          source.faceSizes.begin() + from.faceSize,
+                          source.faceSizes.begin() + from.faceSize + from.faces );
+  for ( int f = 0; f < from.faces; f++ )
+  {
+    int neighbour = source.faceNeighbours[from.faceSize + f];
+    chunk.faceNeighbours.push_back( neighbour >= 0 ? int( members[neighbour] ) : neighbour );
+  }
+
+  cells.volume[id] = output->volume[local];
+  cells.computed[id] = 1;
+}
+
+void Diagram::compact()
+{
+  MeshChunk chunk;
+
+  for ( size_t id = 0; id < size(); id++ )
+  {
+    if ( !computed( id ) )
+      continue;
+
+    MeshSlot& slot = cells.slots[id];
+    const MeshChunk& source = cells.chunks[slot.thread];
+    size_t vertex = chunk.vertices.size(), face = chunk.faces.size();
+    size_t faceSize = chunk.faceSizes.size();
+
+    chunk.vertices.insert( chunk.vertices.end(),
+                           source.vertices.begin() + slot.vertex,
+                           source.vertices.begin() + slot.vertex + 3 * slot.vertices );
+    chunk.faces.insert( chunk.faces.end(),
+                        source.faces.begin() + slot.face,
+                        source.faces.begin() + slot.face + slot.indices );
+    chunk.faceSizes.insert( chunk.faceSizes.end(),
+                            source.faceSizes.begin() + slot.faceSize,
+                            source.faceSizes.begin() + slot.faceSize + slot.faces );
+    chunk.faceNeighbours.insert( chunk.faceNeighbours.end(),
+                                 source.faceNeighbours.begin() + slot.faceSize,
+                                 source.faceNeighbours.begin() + slot.faceSize + slot.faces );
+
+    slot.thread = 0;
+    slot.vertex = vertex;
+    slot.face = face;
+    slot.faceSize = faceSize;
+  }
+
+  cells.chunks.clear();
+  cells.chunks.push_back( std::move( chunk ) );
+  staleVertices = 0;
+}
+
+void Diagram::checkUpdate( int threads ) const
+{
+  if ( threads < 1 )
+    throw std::invalid_argument( "Invalid threads: Value must not be less than 1." );
+
+  // Clipped cells do not tile the container, so their faces do not lead to
+  // every cell that changes
+  if ( !settings.influence.empty() )
+    throw std::invalid_argument(
+      "Invalid diagram: Points cannot be inserted or deleted in a diagram clipped by maxRadius." );
+}
+
+void Diagram::insert( const Points& points, int threads, std::vector< size_t >& changed )
+{
+  checkUpdate( threads );
+
+  if ( ( points.radius != nullptr ) != !radius.empty() )
+  {
+    throw std::invalid_argument( radius.empty()
+      ? "Invalid radius: The diagram has no radii."
+      : "Invalid radius: Values are needed for the points of a power diagram." );
+  }
+
+  Points mapped = points;
+  mapped.anisotropy = anisotropy.get();
+  double at[3];
+  for ( size_t i = 0; i < points.n; i++ )
+  {
+    mapped.at( i, at );
+    if ( !( at[0] >= low[0] && at[0] < high[0] &&
+            at[1] >= low[1] && at[1] < high[1] &&
+            at[2] >= low[2] && at[2] < high[2] ) )
+      throw std::invalid_argument( "Invalid points: Values must lie within the container of the diagram." );
+
+    if ( points.radius && ( !( points.radius[i] >= 0 ) || !isfinite( points.radius[i] ) ) )
+      throw std::invalid_argument( "Invalid radius: Values must be finite and not negative." );
+  }
+
+  // Cells cut by each point, found among the stored cells from the cell
+  // holding the point. With radii, a point may lie outside of its own cell,
+  // and then all cells are tried. A point that cuts no cell is hidden by
+  // larger radii and gets no cell.
+  size_t first = size();
+  std::map< size_t, std::vector< size_t > > owners;
+  std::vector< char > hidden ( points.n, 0 );
+  for ( size_t i = 0; i < points.n; i++ )
+  {
+    mapped.at( i, at );
+    double radius2 = points.radius ? points.radius[i] * points.radius[i] : 0;
+
+    std::vector< size_t > queue;
+    size_t start = owner( at );
+    if ( start < first && cuts( start, at, radius2 ) )
+      queue.push_back( start );
+    else if ( !radius.empty() )
+    {
+      for ( size_t id = 0; id < first; id++ )
+      {
+        if ( cuts( id, at, radius2 ) )
+          queue.push_back( id );
+      }
+    }
+
+    hidden[i] = queue.empty();
+    std::unordered_set< size_t > seen ( queue.begin(), queue.end() );
+    while ( !queue.empty() )
+    {
+      size_t cut = queue.back();
+      queue.pop_back();
+      owners[cut].push_back( first + i );
+
+      const MeshSlot& slot = cells.slots[cut];
+      const int* neighbours = cells.chunks[slot.thread].faceNeighbours.data() + slot.faceSize;
+      for ( int f = 0; f < slot.faces; f++ )
+      {
+        if ( neighbours[f] >= 0 && seen.insert( neighbours[f] ).second &&
+             cuts( neighbours[f], at, radius2 ) )
+          queue.push_back( neighbours[f] );
+      }
+    }
+  }
+
+  for ( size_t i = 0; i < points.n; i++ )
+  {
+    x.push_back( points.x[i] );
+    y.push_back( points.y[i] );
+    z.push_back( points.z[i] );
+    if ( points.radius )
+      radius.push_back( points.radius[i] );
+    alive.push_back( 1 );
+    cells.computed.push_back( 0 );
+    cells.volume.push_back( NAN );
+    cells.slots.push_back( MeshSlot() );
+  }
+
+  double maxRadius = 0;
+  for ( size_t id = 0; id < radius.size(); id++ )
+  {
+    if ( alive[id] )
+      maxRadius = std::max( maxRadius, radius[id] );
+  }
+
+  // The cells cut by a point and the cell of the point lie in the stored
+  // cells that it cuts
+  std::vector< double > spheres;
+  std::vector< size_t > computedIds;
+  for ( std::pair< const size_t, std::vector< size_t > >& cut : owners )
+  {
+    cut.second.push_back( cut.first );
+    addSpheres( cut.first, cut.second, maxRadius, spheres );
+    computedIds.push_back( cut.first );
+  }
+  for ( size_t i = 0; i < points.n; i++ )
+  {
+    if ( !hidden[i] )
+      computedIds.push_back( first + i );
+  }
+
+  // The cells are stored only once they are all computed, so if that fails,
+  // dropping the inserted points leaves the diagram as it was
+  try
+  {
+    recompute( computedIds, spheres, threads );
+  }
+  catch ( ... )
+  {
+    x.resize( first );
+    y.resize( first );
+    z.resize( first );
+    if ( !radius.empty() )
+      radius.resize( first );
+    alive.resize( first );
+    cells.computed.resize( first );
+    cells.volume.resize( first );
+    cells.slots.resize( first );
+    throw;
+  }
+  locator.reset();
+
+  changed.clear();
+  for ( std::pair< const size_t, std::vector< size_t > >& cut : owners )
+    changed.push_back( cut.first );
+  for ( size_t id = first; id < size(); id++ )
+    changed.push_back( id );
+}
+
+void Diagram::remove( const std::vector< size_t >& ids, int threads, std::vector< size_t >& changed )
+{
+  checkUpdate( threads );
+
+  std::vector< size_t > removed = ids;
+  std::sort( removed.begin(), removed.end() );
+  for ( size_t i = 0; i < removed.size(); i++ )
+  {
+    if ( removed[i] >= size() || !alive[removed[i]] )
+      throw std::invalid_argument( "Invalid ids: Values must be indices of points that are not deleted." );
+    if ( i > 0 && removed[i] == removed[i - 1] )
+      throw std::invalid_argument( "Invalid ids: Values must be unique." );
+  }
+
+  if ( size_t( std::count( alive.begin(), alive.end(), 1 ) ) < removed.size() + 2 )
+    throw std::invalid_argument( "Cannot generate cells if points are less than 2." );
+
+  // Groups of deleted points whose cells touch, and the remaining points next
+  // to each group, whose cells grow into the cells of the group
+  std::unordered_map< size_t, size_t > group;
+  std::vector< std::vector< size_t > > members, neighbours;
+  std::map< size_t, std::vector< size_t > > freed;
+  for ( size_t id : removed )
+    group.emplace( id, removed.size() );
+
+  for ( size_t id : removed )
+  {
+    if ( group[id] != removed.size() )
+      continue;
+
+    size_t g = members.size();
+    members.emplace_back();
+    neighbours.emplace_back();
+    group[id] = g;
+
+    std::vector< size_t > queue ( 1, id );
+    while ( !queue.empty() )
+    {
+      size_t member = queue.back();
+      queue.pop_back();
+      members[g].push_back( member );
+      if ( !computed( member ) )
+        continue;
+
+      const MeshSlot& slot = cells.slots[member];
+      const int* faces = cells.chunks[slot.thread].faceNeighbours.data() + slot.faceSize;
+      for ( int f = 0; f < slot.faces; f++ )
+      {
+        if ( faces[f] < 0 )
+          continue;
+
+        freed[member].push_back( faces[f] );
+        auto found = group.find( faces[f] );
+        if ( found == group.end() )
+          neighbours[g].push_back( faces[f] );
+        else if ( found->second == removed.size() )
+        {
+          found->second = g;
+          queue.push_back( faces[f] );
+        }
+      }
+    }
+
+    std::sort( neighbours[g].begin(), neighbours[g].end() );
+    neighbours[g].erase( std::unique( neighbours[g].begin(), neighbours[g].end() ),
+                         neighbours[g].end() );
+  }
+
+  for ( size_t id : removed )
+    alive[id] = 0;
+
+  double maxRadius = 0;
+  for ( size_t id = 0; id < radius.size(); id++ )
+  {
+    if ( alive[id] )
+      maxRadius = std::max( maxRadius, radius[id] );
+  }
+
+  std::vector< double > spheres;
+  std::vector< size_t > grown;
+  for ( size_t g = 0; g < members.size(); g++ )
+  {
+    for ( size_t member : members[g] )
+      addSpheres( member, neighbours[g], maxRadius, spheres );
+
+    for ( size_t neighbour : neighbours[g] )
+    {
+      addSpheres( neighbour, std::vector< size_t >( 1, neighbour ), maxRadius, spheres );
+      grown.push_back( neighbour );
+    }
+  }
+
+  std::sort( grown.begin(), grown.end() );
+  grown.erase( std::unique( grown.begin(), grown.end() ), grown.end() );
+
+  for ( size_t id : removed )
+    storeCell( id, nullptr, 0, removed );
+  recompute( grown, spheres, threads, &freed );
+  locator.reset();
+
+  changed.clear();
+  std::merge( grown.begin(), grown.end(), removed.begin(), removed.end(),
+              std::back_inserter( changed ) );
+}
+
+size_t Diagram::bytes() const
+{
+  size_t total = ( x.capacity() + y.capacity() + z.capacity() + radius.capacity()
+                   + cells.volume.capacity() ) * sizeof( double )
+    + cells.computed.capacity() + alive.capacity()
+    + cells.slots.capacity() * sizeof( MeshSlot );
+
+  for ( const MeshChunk& chunk : cells.chunks )
+  {
+    total += chunk.vertices.capacity() * sizeof( double )
+      + ( chunk.faces.capacity() + chunk.faceSizes.capacity()
+          + chunk.faceNeighbours.capacity() ) * sizeof( int );
+  }
+
+  return total;
+}
@@ -0,0 +1,173 @@
+#ifndef DIAGRAM_H
+#define DIAGRAM_H
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "engine.h"
+#include "locate.h"
+
+// Voronoi diagram kept in memory, so that one computation serves many
+// queries: its cells can be written in any format, for all points or a
+// subset, and points can be located in it, without computing the cells
+// again. Each cell is stored once as a compact mesh of polygons with the
+// neighbour of each face and its volume, and the diagram holds a container of
+// its points for locating queries. The coordinates and radii are copied, so
+// the diagram does not depend on the arrays it was built from. Points can be
+// inserted and deleted, computing again only the cells that change; the
+// container of the cells stays that of the points the diagram was built
+// from.
+class Diagram
+{
+public:
+  // Compute the cells of `points` with `options`, whose output and profile
+  // are ignored. A terrain cannot be used, since clipped cells have no
+  // single neighbour per face.
+  Diagram( const Points& points, const CellOptions& options );
+
+  Diagram( const Diagram& ) = delete;
+  Diagram& operator=( const Diagram& ) = delete;
+
+  // Number of points, including deleted points
+  size_t size() const { return x.size(); }
+
+  // Options the diagram was computed with
+  const CellOptions& options() const { return settings; }
+
+  // True if the cell of point `id` could be computed
+  bool computed( size_t id ) const { return cells.computed[id] != 0; }
+
+  // Volume of the cell of point `id`, or NaN if it was not computed
+  double volume( size_t id ) const { return cells.volume[id]; }
+
+  // Number of faces of the cell of point `id`
+  int faces( size_t id ) const { return computed( id ) ? cells.slots[id].faces : 0; }
+
+  // Mesh of the cell of point `id` with the neighbour of each face. The faces
+  // are oriented away from the centroid of the vertices, which is the point
+  // stored in `mesh.x`, `mesh.y` and `mesh.z`.
+  void mesh( size_t id, CellMesh& mesh ) const;
+
+  // Write the cells of the points `ids` to `output` in the format `format`,
+  // as `computeOutput()` would for these points, on `threads` threads.
+  // Neighbours are point ids of the whole diagram. OUTPUT_BLOCKS needs the
+  // cells themselves and cannot be written.
+  void write( const std::vector< size_t >& ids,
+              OutputFormat format,
+              bool polygons,
+              int precision,
+              int threads,
+              CellOutput& output ) const;
+
+  // Locate `queries` as `locatePoints()` does, in the held container if it
+  // covers them, or else in a container extended over them. With anisotropy,
+  // queries are located in the space where the anisotropy is a sphere, so
+  // that they fall in the cells of the diagram, and distances are measured
+  // there. Power diagrams cannot locate queries, since the nearest point is
+  // not always the one whose cell holds the query.
+  void locate( const Points& queries,
+               int threads,
+               std::vector< int >& index,
+               std::vector< double >& distance );
+
+  // Insert `points`, which get the ids following those of the diagram, and
+  // compute again only the cells they change. The cells changed by a point
+  // are found from the cell that holds it through the neighbours of the
+  // faces: a cell changes if the point is closer to one of its vertices than
+  // its own point, in the power distance with radii. They are computed with
+  // the points within reach of their vertices, in a container over these
+  // points that keeps the sides of the container of the diagram. `changed`
+  // receives the ids of the changed cells and of the inserted points, in
+  // increasing order. With radii, a point that cuts no cell is hidden and
+  // gets no cell. The points must lie in the container of the diagram and
+  // have radii if and only if the diagram has. If the cells cannot be
+  // computed, the points are not inserted.
+  void insert( const Points& points, int threads, std::vector< size_t >& changed );
+
+  // Delete the points `ids` and compute again the cells of their neighbours,
+  // the only ones that change, as `insert()` does. The ids of the other
+  // points stay the same, and the deleted points keep their ids without a
+  // cell. With radii, a point whose cell was empty may get a cell within the
+  // cells of the deleted points, so the points without a cell near them are
+  // computed again as well. `changed` receives the ids of the neighbours, of
+  // the points that got a cell and of the deleted points, in increasing order.
+  void remove( const std::vector< size_t >& ids, int threads, std::vector< size_t >& changed );
+
+  // True if point `id` was deleted by `remove()`
+  bool deleted( size_t id ) const { return !alive[id]; }
+
+  // Approximate bytes held by the diagram
+  size_t bytes() const;
+
+private:
+  std::vector< double > x, y, z, radius;
+  std::vector< char > alive;
+  CellOptions settings;
+  std::unique_ptr< Anisotropy > anisotropy;
+  CellOutput cells;
+
+  // Bounds of the container of the cells, in the space of the cells
+  double low[3], high[3];
+
+  // Container of the points that are not deleted, in the order of their
+  // ids, built again on demand after the points change
+  std::unique_ptr< PointLocator > locator;
+
+  // Values of the vertices of stored cells that were replaced, left in the
+  // chunks until they are compacted
+  size_t staleVertices = 0;
+
+  // Points of the diagram in the space of the cells, without radii
+  Points sourcePoints() const;
+
+  // Position of point `id` in the space of the cells
+  void position( size_t id, double* at ) const;
+
+  // Power distance from `at`, in the space of the cells, to point `id`
+  double power( const double* at, size_t id ) const;
+
+  // True if a point at `at` with the squared radius `radius2`, both in the
+  // space of the cells, cuts the stored cell of point `id`
+  bool cuts( size_t id, const double* at, double radius2 ) const;
+
+  // Point whose stored cell holds `at` in the power distance, found by
+  // walking through the neighbours from the nearest of a sample of the
+  // points, or the size of the diagram if no cell is stored
+  size_t owner( const double* at ) const;
+
+  // Compute again the cells of the points `ids`, in increasing order, in a
+  // container of the points within the spheres `spheres`, given as centers
+  // and squared radii in the space of the cells, which hold every point that
+  // can cut them. Unless `freed` is null, it maps each deleted point to the
+  // points its cell had faces with, and the points of the container without
+  // a cell whose new cell lies in the cells of the deleted points are stored
+  // as well and added to `ids`.
+  void recompute( std::vector< size_t >& ids,
+                  const std::vector< double >& spheres,
+                  int threads,
+                  const std::map< size_t, std::vector< size_t > >* freed = nullptr );
+
+  // Add the spheres around the vertices of the stored cell of point `id`
+  // reaching the points that can cut the cells of the points `owners` there
+  void addSpheres( size_t id,
+                   const std::vector< size_t >& owners,
+                   double maxRadius,
+                   std::vector< double >& spheres ) const;
+
+  // Replace the stored cell of point `id` by the cell `local` of `output`,
+  // whose neighbours are indices of `members`, or drop it if `output` is
+  // null
+  void storeCell( size_t id,
+                  const CellOutput* output,
+                  size_t local,
+                  const std::vector< size_t >& members );
+
+  // Check the arguments shared by `insert()` and `remove()`
+  void checkUpdate( int threads ) const;
+
+  // Write the stored cells to one chunk without the stale values
+  void compact();
+};
+
+#endif
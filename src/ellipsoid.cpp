@@ -0,0 +1,39 @@
+#include <math.h>
+#include <stdexcept>
+#include <string>
+#include "ellipsoid.h"
+
+void checkEllipsoid( const Ellipsoid& ellipsoid, const char* name )
+{
+  for ( int a = 0; a < 3; a++ )
+  {
+    if ( !( ellipsoid.ranges[a] > 0 ) || !isfinite( ellipsoid.ranges[a] ) )
+      throw std::invalid_argument( std::string( "Invalid " ) + name +
+                                   ": Ranges must be positive and finite." );
+
+    if ( !isfinite( ellipsoid.angles[a] ) )
+      throw std::invalid_argument( std::string( "Invalid " ) + name +
+                                   ": Angles must be finite." );
+  }
+}
+
+void ellipsoidAxes( const Ellipsoid& ellipsoid, double axes[3][3] )
+{
+  const double degree = M_PI / 180;
+  double strike = ellipsoid.angles[0] * degree;
+  double dip = ellipsoid.angles[1] * degree;
+  double plunge = ellipsoid.angles[2] * degree;
+
+  // Major axis, and the horizontal and upward axes perpendicular to it
+  // before the plunge
+  double major[3] = { sin( strike ) * cos( dip ), cos( strike ) * cos( dip ), -sin( dip ) };
+  double across[3] = { cos( strike ), -sin( strike ), 0 };
+  double up[3] = { sin( strike ) * sin( dip ), cos( strike ) * sin( dip ), cos( dip ) };
+
+  for ( int a = 0; a < 3; a++ )
+  {
+    axes[0][a] = major[a];
+    axes[1][a] = cos( plunge ) * across[a] + sin( plunge ) * up[a];
+    axes[2][a] = cos( plunge ) * up[a] - sin( plunge ) * across[a];
+  }
+}
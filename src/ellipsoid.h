@@ -0,0 +1,24 @@
+#ifndef ELLIPSOID_H
+#define ELLIPSOID_H
+
+// Ellipsoid with the semi-axis lengths `ranges` along its major, semi-major
+// and minor axes, oriented by the `angles` in degrees: the strike, azimuth of
+// the major axis clockwise from the y axis, the dip of the major axis below
+// the horizontal and the plunge, rotation of the two other axes about the
+// major axis. With no rotation the axes are y, x and z.
+struct Ellipsoid
+{
+  double ranges[3] = { 0, 0, 0 };
+  double angles[3] = { 0, 0, 0 };
+
+  bool empty() const { return ranges[0] == 0 && ranges[1] == 0 && ranges[2] == 0; }
+};
+
+// Check that the ranges are positive and the angles finite. `name` is the
+// option reported in the error.
+void checkEllipsoid( const Ellipsoid& ellipsoid, const char* name );
+
+// Unit vectors along the major, semi-major and minor axes of `ellipsoid`
+void ellipsoidAxes( const Ellipsoid& ellipsoid, double axes[3][3] );
+
+#endif
@@ -0,0 +1,746 @@
+#include <algorithm>
+#include <math.h>
+#include <mutex>
+#include <unordered_map>
+#include "engine.h"
+#include "wkb.h"
+#include "wkt.h"
+
+OutputFormat outputFormat( const std::string& name )
+{
+  if ( name == "wkt" )
+    return OUTPUT_WKT;
+  if ( name == "wkb" )
+    return OUTPUT_WKB;
+  if ( name == "mesh" )
+    return OUTPUT_MESH;
+  if ( name == "volume" )
+    return OUTPUT_VOLUME;
+  if ( name == "adjacency" )
+    return OUTPUT_ADJACENCY;
+  if ( name == "blocks" )
+    return OUTPUT_BLOCKS;
+
+  throw std::invalid_argument(
+    "Invalid output: Value must be \"wkt\", \"wkb\", \"mesh\", \"volume\", \"adjacency\" or \"blocks\"." );
+}
+
+void checkOptions( const Points& points, const CellOptions& options )
+{
+  if ( points.n < 2 )
+    throw std::invalid_argument( "Cannot generate cells if points are less than 2." );
+
+  if ( !( options.containerRatio >= 1 ) )
+    throw std::invalid_argument( "Invalid containerRatio: Value must not be less than 1." );
+
+  if ( options.threads < 1 )
+    throw std::invalid_argument( "Invalid threads: Value must not be less than 1." );
+
+  if ( options.precision > 20 )
+    throw std::invalid_argument( "Invalid precision: Value must not be greater than 20." );
+
+  checkGrid( options.grid );
+  checkWalls( options.walls );
+
+  if ( !options.influence.empty() )
+    checkEllipsoid( options.influence, "maxRadius" );
+
+  for ( size_t i = 0; points.radius && i < points.n; i++ )
+  {
+    if ( !( points.radius[i] >= 0 ) || !isfinite( points.radius[i] ) )
+      throw std::invalid_argument( "Invalid radius: Values must be finite and not negative." );
+  }
+
+  if ( ( options.output == OUTPUT_ADJACENCY || options.output == OUTPUT_CELLS ) &&
+       !options.dem.empty() )
+    throw std::invalid_argument( "Invalid output: Adjacency cannot be combined with a dem." );
+
+  if ( options.output == OUTPUT_BLOCKS )
+  {
+    checkBlockModel( options.blockModel );
+    if ( !options.dem.empty() )
+      throw std::invalid_argument( "Invalid output: Blocks cannot be combined with a dem." );
+  }
+
+  if ( !options.anisotropy.empty() )
+  {
+    checkEllipsoid( options.anisotropy, "anisotropy" );
+    if ( !options.walls.cylinders.empty() || !options.dem.empty() )
+      throw std::invalid_argument( "Invalid anisotropy: Cannot be combined with cylinders or a dem." );
+  }
+
+  if ( !options.dem.empty() )
+    checkDem( options.dem );
+}
+
+double setThreshold( double x )
+{
+  // Hard coded threshold is 2 meters
+  const double threshold = 2;
+
+  if ( x < threshold )
+    return threshold;
+  else
+    return x;
+}
+
+std::unique_ptr< voro::container > pointContainer( const Points& points,
+                                                   double containerRatio,
+                                                   const GridOptions& grid )
+{
+  return gridContainer( points, containerGrid( points, containerRatio, grid ) );
+}
+
+size_t CellWorker::scratchBytes() const
+{
+  return vc.current_vertices * ( 3 * sizeof( double ) + sizeof( int* )
+                                 + sizeof( int ) )
+    + ( vc.current_delete_size + vc.current_delete2_size ) * sizeof( int )
+    + mesh.vertices.capacity() * sizeof( double )
+    + ( mesh.faceVertices.capacity() + mesh.faceOffsets.capacity() ) * sizeof( int )
+    + faces.bytes()
+    + neighbourCell.current_vertices * ( 3 * sizeof( double ) + 2 * sizeof( int* )
+                                         + sizeof( int ) )
+    + neighbours.capacity() * sizeof( int )
+    + ( areas.capacity() + normals.capacity() ) * sizeof( double );
+}
+
+CellWorkers cellWorkers( int threads )
+{
+  CellWorkers workers;
+  for ( int t = 0; t < threads; t++ )
+    workers.emplace_back( new CellWorker() );
+  return workers;
+}
+
+void appendFaces( const CellMesh& mesh,
+                  const FaceList& faces,
+                  int thread,
+                  MeshChunk& chunk,
+                  MeshSlot& slot )
+{
+  slot.thread = thread;
+  slot.vertex = chunk.vertices.size();
+  slot.face = chunk.faces.size();
+  slot.faceSize = chunk.faceSizes.size();
+  slot.vertices = mesh.vertices.size() / 3;
+  slot.faces = faces.faces();
+  slot.indices = faces.vertices.size();
+
+  chunk.vertices.insert( chunk.vertices.end(),
+                         mesh.vertices.begin(), mesh.vertices.end() );
+  chunk.faces.insert( chunk.faces.end(),
+                      faces.vertices.begin(), faces.vertices.end() );
+  for ( int f = 0; f < slot.faces; f++ )
+    chunk.faceSizes.push_back( faces.offsets[f + 1] - faces.offsets[f] );
+}
+
+void appendWalk( const CellMesh& mesh, int thread, WalkChunk& chunk, WalkSlot& slot )
+{
+  slot.thread = thread;
+  slot.point = chunk.points.size();
+  slot.vertex = chunk.vertices.size();
+  slot.index = chunk.faceVertices.size();
+  slot.face = chunk.faceSizes.size();
+  slot.faceOrigin = chunk.faceOrigins.size();
+  slot.vertices = mesh.vertices.size() / 3;
+  slot.indices = mesh.faceVertices.size();
+  slot.faces = mesh.faces();
+  slot.origins = !mesh.faceOrigins.empty();
+
+  chunk.points.push_back( mesh.x );
+  chunk.points.push_back( mesh.y );
+  chunk.points.push_back( mesh.z );
+  chunk.vertices.insert( chunk.vertices.end(),
+                         mesh.vertices.begin(), mesh.vertices.end() );
+  chunk.faceVertices.insert( chunk.faceVertices.end(),
+                             mesh.faceVertices.begin(), mesh.faceVertices.end() );
+  for ( int f = 0; f < slot.faces; f++ )
+    chunk.faceSizes.push_back( mesh.faceOffsets[f + 1] - mesh.faceOffsets[f] );
+  chunk.faceOrigins.insert( chunk.faceOrigins.end(),
+                            mesh.faceOrigins.begin(), mesh.faceOrigins.end() );
+}
+
+void loadWalk( const WalkChunk& chunk, const WalkSlot& slot, CellMesh& mesh )
+{
+  mesh.x = chunk.points[slot.point];
+  mesh.y = chunk.points[slot.point + 1];
+  mesh.z = chunk.points[slot.point + 2];
+
+  auto vertices = chunk.vertices.begin() + slot.vertex;
+  mesh.vertices.assign( vertices, vertices + 3 * slot.vertices );
+
+  auto indices = chunk.faceVertices.begin() + slot.index;
+  mesh.faceVertices.assign( indices, indices + slot.indices );
+
+  mesh.faceOffsets.assign( 1, 0 );
+  for ( int f = 0; f < slot.faces; f++ )
+    mesh.faceOffsets.push_back( mesh.faceOffsets.back() + chunk.faceSizes[slot.face + f] );
+
+  mesh.faceNeighbours.clear();
+  mesh.faceOrigins.clear();
+  if ( slot.origins )
+  {
+    auto origins = chunk.faceOrigins.begin() + slot.faceOrigin;
+    mesh.faceOrigins.assign( origins, origins + 3 * slot.faces );
+  }
+}
+
+PointGroups pointGroups( const int* codes, size_t n )
+{
+  PointGroups groups;
+  std::unordered_map< int, size_t > index;
+
+  for ( size_t i = 0; i < n; i++ )
+  {
+    if ( codes[i] < 0 )
+      continue;
+
+    auto found = index.emplace( codes[i], groups.members.size() );
+    if ( found.second )
+      groups.members.emplace_back();
+    groups.members[found.first->second].push_back( i );
+  }
+
+  return groups;
+}
+
+// Add the work of `worker` on `thread` to `profile`. `scratch` holds the
+// largest scratch space of each thread.
+static void addProfile( const CellWorker& worker,
+                        int thread,
+                        RunProfile& profile,
+                        std::vector< double >& scratch )
+{
+  profile.compute += worker.profile.compute;
+  profile.walk += worker.profile.walk;
+  profile.write += worker.profile.write;
+  profile.cells += worker.profile.cells;
+  profile.failed += worker.profile.failed;
+  scratch[thread] = std::max( scratch[thread], double( worker.scratchBytes() ) );
+}
+
+// Orient the faces of `mesh`, walked from the cell `vc`, from the centroid of
+// the cell instead of its particle, which a cell of the power diagram may not
+// contain. `offsetMap` maps offsets as in `walkCell()`.
+template < class Cell >
+static void orientFromCentroid( Cell& vc,
+                                const double* offsetMap,
+                                CellMesh& mesh )
+{
+  double centroid[3];
+  vc.centroid( centroid[0], centroid[1], centroid[2] );
+
+  const double* m = offsetMap;
+  if ( m )
+  {
+    double offset[3] = { centroid[0], centroid[1], centroid[2] };
+    for ( int a = 0; a < 3; a++ )
+      centroid[a] = m[3 * a] * offset[0] + m[3 * a + 1] * offset[1] + m[3 * a + 2] * offset[2];
+  }
+
+  mesh.x += centroid[0];
+  mesh.y += centroid[1];
+  mesh.z += centroid[2];
+}
+
+// Number of consecutive points whose cells are written to a stream as one
+// chunk
+static const size_t STREAM_BATCH = 64;
+
+// `computeOutput()` with the instrumentation compiled in or out. If `groups`
+// is null, all points are in one container. If `stream` is not null, the
+// cells are written to it as in `streamOutput()`.
+template < bool Profiled >
+void computeOutputAs( const Points& points,
+                      const PointGroups* groups,
+                      const CellOptions& options,
+                      CellOutput& output,
+                      const CellStream* stream = nullptr )
+{
+  size_t n = points.n;
+  int threads = options.threads;
+  bool polygons = options.polygons;
+  OutputFormat format = stream ? OUTPUT_WKT : options.output;
+  RunProfile& profile = output.profile;
+  Stopwatch< Profiled > overall;
+  std::mutex profileMutex;
+  std::vector< double > scratch ( threads, 0 );
+
+  overall.start();
+  output.format = format;
+  output.computed.assign( n, 0 );
+  bool deferText = format == OUTPUT_WKT && options.deferText && !stream;
+  bool text = format == OUTPUT_WKT && !deferText && !stream;
+  output.wkt.resize( text ? n : 0 );
+  output.walks.resize( deferText ? threads : 0 );
+  output.walkSlots.resize( deferText ? n : 0 );
+  output.wkb.resize( format == OUTPUT_WKB ? n : 0 );
+  bool meshes = format == OUTPUT_MESH || format == OUTPUT_CELLS;
+  bool neighbours = format == OUTPUT_ADJACENCY || format == OUTPUT_CELLS;
+  output.chunks.resize( meshes ? threads : 0 );
+  output.slots.resize( meshes ? n : 0 );
+  output.volume.assign( format == OUTPUT_VOLUME || format == OUTPUT_CELLS ? n : 0, NAN );
+  output.adjacency.resize( format == OUTPUT_ADJACENCY ? threads : 0 );
+  output.adjacencySlots.resize( format == OUTPUT_ADJACENCY ? n : 0 );
+  output.blocks.resize( format == OUTPUT_BLOCKS ? threads : 0 );
+  output.blockSlots.resize( format == OUTPUT_BLOCKS ? n : 0 );
+
+  std::vector< WktWriter > writers ( text ? threads : 0,
+                                     WktWriter( NumberFormat( options.precision ) ) );
+
+  // Records of the cells of the current batch of each thread
+  std::unique_ptr< ReorderBuffer > buffer;
+  std::vector< RecordWriter > records;
+  std::vector< std::string > batches;
+  if ( stream )
+  {
+    buffer.reset( new ReorderBuffer( stream->file, stream->bufferBytes ) );
+    records.assign( threads, RecordWriter( stream->format, NumberFormat( options.precision ),
+                                           polygons ) );
+    batches.resize( threads );
+
+    std::string header = records[0].header();
+    buffer->write( 0, header );
+  }
+
+  // Points, walls and offsets in the space where the cells are computed
+  std::unique_ptr< Anisotropy > anisotropy;
+  Points source = points;
+  Walls walls = options.walls;
+  const double* offsetMap = nullptr;
+  double volumeRatio = 1;
+  if ( !options.anisotropy.empty() )
+  {
+    anisotropy.reset( new Anisotropy( options.anisotropy ) );
+    source.anisotropy = anisotropy.get();
+    walls = anisotropy->walls( options.walls );
+    offsetMap = anisotropy->inverse();
+    volumeRatio = anisotropy->volumeRatio();
+  }
+
+  std::unique_ptr< InfluenceWall > influence;
+  if ( !options.influence.empty() )
+    influence.reset( new InfluenceWall( options.influence, offsetMap ) );
+
+  std::vector< std::unique_ptr< DemClipper > > clippers;
+  for ( int t = 0; t < threads && !options.dem.empty(); t++ )
+    clippers.emplace_back( new DemClipper( options.dem ) );
+
+  std::vector< std::unique_ptr< BlockSplitter > > splitters;
+  for ( int t = 0; t < threads && format == OUTPUT_BLOCKS; t++ )
+    splitters.emplace_back( new BlockSplitter( options.blockModel, offsetMap, volumeRatio ) );
+
+  // Store the neighbours of the cell of point `id` with the areas of their
+  // faces. Neighbours are mapped from the container of `members`.
+  auto storeAdjacency = [&]( CellWorker& worker, size_t id, int thread,
+                             const std::vector< size_t >* members )
+  {
+    voro::voronoicell_neighbor& cell = worker.neighbourCell;
+    if ( influence && !influence->clip( cell ) )
+      return;
+
+    cell.neighbors( worker.neighbours );
+    cell.face_areas( worker.areas );
+    if ( anisotropy )
+    {
+      cell.normals( worker.normals );
+      for ( size_t f = 0; f < worker.areas.size(); f++ )
+        worker.areas[f] *= anisotropy->areaRatio( worker.normals.data() + 3 * f );
+    }
+
+    AdjacencyChunk& chunk = output.adjacency[thread];
+    AdjacencySlot& slot = output.adjacencySlots[id];
+    slot.thread = thread;
+    slot.face = chunk.neighbours.size();
+    slot.faces = worker.neighbours.size();
+
+    for ( int neighbour : worker.neighbours )
+    {
+      if ( neighbour >= 0 && members )
+        neighbour = int( ( *members )[neighbour] );
+      chunk.neighbours.push_back( neighbour );
+    }
+    chunk.areas.insert( chunk.areas.end(), worker.areas.begin(), worker.areas.end() );
+    output.computed[id] = 1;
+  };
+
+  // Store the mesh of the cell of point `id` with the neighbours of its faces,
+  // mapped from the container of `members`, and its volume
+  auto storeCell = [&]( CellWorker& worker, size_t id, int thread,
+                        const std::vector< size_t >* members )
+  {
+    voro::voronoicell_neighbor& cell = worker.neighbourCell;
+    if ( influence && !influence->clip( cell ) )
+      return;
+
+    walkCell( cell, points.x[id], points.y[id], points.z[id], worker.mesh, offsetMap );
+    if ( points.radius )
+      orientFromCentroid( cell, offsetMap, worker.mesh );
+
+    MeshChunk& chunk = output.chunks[thread];
+    worker.mesh.orientedFaces( true, worker.faces );
+    appendFaces( worker.mesh, worker.faces, thread, chunk, output.slots[id] );
+    for ( int neighbour : worker.mesh.faceNeighbours )
+    {
+      if ( neighbour >= 0 && members )
+        neighbour = int( ( *members )[neighbour] );
+      chunk.faceNeighbours.push_back( neighbour );
+    }
+
+    output.volume[id] = cell.volume() * volumeRatio;
+    output.computed[id] = 1;
+  };
+
+  // Store the cell of point `id`
+  auto store = [&]( CellWorker& worker, size_t id, const double* position, int thread,
+                    const std::vector< size_t >* members )
+  {
+    Stopwatch< Profiled > cellStopwatch;
+    TerrainSide side = BELOW_TERRAIN;
+
+    cellStopwatch.start();
+    if ( format == OUTPUT_ADJACENCY )
+    {
+      storeAdjacency( worker, id, thread, members );
+      cellStopwatch.lap( worker.profile.walk );
+      return;
+    }
+
+    if ( format == OUTPUT_CELLS )
+    {
+      storeCell( worker, id, thread, members );
+      cellStopwatch.lap( worker.profile.walk );
+      return;
+    }
+
+    if ( influence && !influence->clip( worker.vc ) )
+      return;
+
+    if ( format == OUTPUT_BLOCKS )
+    {
+      BlockChunk& chunk = output.blocks[thread];
+      BlockSlot& slot = output.blockSlots[id];
+      slot.thread = thread;
+      slot.part = chunk.blocks.size();
+      splitters[thread]->split( worker.vc, points.x[id], points.y[id], points.z[id],
+                                chunk.blocks, chunk.volumes );
+      slot.parts = chunk.blocks.size() - slot.part;
+      output.computed[id] = 1;
+      cellStopwatch.lap( worker.profile.walk );
+      return;
+    }
+
+    if ( !clippers.empty() )
+    {
+      side = clippers[thread]->side( worker.vc, position[0], position[1], position[2] );
+      if ( side == ABOVE_TERRAIN )
+        return;
+    }
+
+    if ( format == OUTPUT_VOLUME )
+    {
+      double volume = side == CROSSES_TERRAIN
+        ? clippers[thread]->clip( worker.vc, position[0], position[1], position[2], nullptr )
+        : worker.vc.volume() * volumeRatio;
+
+      if ( volume > 0 || side != CROSSES_TERRAIN )
+      {
+        output.computed[id] = 1;
+        output.volume[id] = volume;
+      }
+      return;
+    }
+
+    double volume = NAN;
+    if ( side == CROSSES_TERRAIN )
+    {
+      volume = clippers[thread]->clip( worker.vc, position[0], position[1], position[2],
+                                       &worker.mesh );
+      if ( worker.mesh.faces() == 0 )
+        return;
+    }
+
+    else if ( offsetMap )
+      walkCell( worker.vc, points.x[id], points.y[id], points.z[id], worker.mesh, offsetMap );
+
+    else
+      walkCell( worker.vc, position[0], position[1], position[2], worker.mesh );
+
+    if ( points.radius && side != CROSSES_TERRAIN )
+      orientFromCentroid( worker.vc, offsetMap, worker.mesh );
+    cellStopwatch.lap( worker.profile.walk );
+
+    output.computed[id] = 1;
+
+    if ( stream )
+    {
+      if ( side != CROSSES_TERRAIN )
+        volume = worker.vc.volume() * volumeRatio;
+      records[thread].append( id, &worker.mesh, volume, batches[thread] );
+    }
+
+    else if ( deferText )
+      appendWalk( worker.mesh, thread, output.walks[thread], output.walkSlots[id] );
+
+    else if ( format == OUTPUT_WKT )
+      writers[thread].write( worker.mesh, polygons, output.wkt[id] );
+
+    else if ( format == OUTPUT_WKB )
+      cellWkb( worker.mesh, polygons, worker.faces, output.wkb[id] );
+
+    else
+    {
+      worker.mesh.orientedFaces( polygons, worker.faces );
+      appendFaces( worker.mesh, worker.faces, thread,
+                   output.chunks[thread], output.slots[id] );
+    }
+    cellStopwatch.lap( worker.profile.write );
+  };
+
+  // Compute the cells of the points `members`, or of all points if null, in
+  // their own container. The cells are computed on `thread` or, if
+  // `groupThreads` is more than 1, on all threads.
+  auto computeGroup = [&]( const std::vector< size_t >* members,
+                           int thread,
+                           int groupThreads,
+                           bool largest )
+  {
+    Points groupPoints = source;
+    std::vector< double > x, y, z, radius;
+    Stopwatch< Profiled > stopwatch;
+    double put = 0;
+
+    stopwatch.start();
+    if ( members )
+    {
+      for ( size_t i : *members )
+      {
+        x.push_back( points.x[i] );
+        y.push_back( points.y[i] );
+        z.push_back( points.z[i] );
+        if ( points.radius )
+          radius.push_back( points.radius[i] );
+      }
+      groupPoints = Points { x.data(), y.data(), z.data(), members->size(),
+                             source.anisotropy,
+                             points.radius ? radius.data() : nullptr };
+    }
+
+    ContainerWalls containerWalls ( walls );
+    ContainerGrid grid = containerGrid( groupPoints, options.containerRatio, options.grid );
+
+    // Compute the cells of the container `con` holding the group
+    auto computeContainer = [&]( auto& con )
+    {
+      containerWalls.addTo( con );
+      if ( influence )
+        con.add_wall( *influence );
+      CellWorkers workers = cellWorkers( groupThreads );
+      stopwatch.lap( put );
+
+      if ( stream )
+      {
+        // Threads waiting for their turn to write are released if any
+        // thread fails
+        computeCellsInOrder< Profiled >( con, workers, n, STREAM_BATCH,
+                                         [&]( CellWorker& worker,
+                                              size_t id,
+                                              const double* position,
+                                              int workerThread )
+        {
+          try
+          {
+            if ( position )
+              store( worker, id, position, workerThread, nullptr );
+            if ( !output.computed[id] )
+              records[workerThread].append( id, nullptr, NAN, batches[workerThread] );
+          }
+          catch ( ... )
+          {
+            buffer->abort();
+            throw;
+          }
+        }, [&]( int batch, int workerThread )
+        {
+          try
+          {
+            buffer->write( batch + 1, batches[workerThread] );
+          }
+          catch ( ... )
+          {
+            buffer->abort();
+            throw;
+          }
+        } );
+      }
+
+      else
+      {
+        computeCells< Profiled >( con, workers, [&]( CellWorker& worker,
+                                                     int id,
+                                                     const double* position,
+                                                     int workerThread )
+        {
+          store( worker, members ? ( *members )[id] : id, position,
+                 groupThreads > 1 ? workerThread : thread, members );
+        }, neighbours );
+      }
+
+      if ( Profiled )
+      {
+        std::lock_guard< std::mutex > lock ( profileMutex );
+        profile.put += put;
+        if ( largest )
+          std::copy( grid.blocks, grid.blocks + 3, profile.blocks );
+        for ( size_t t = 0; t < workers.size(); t++ )
+          addProfile( *workers[t], groupThreads > 1 ? t : thread, profile, scratch );
+      }
+    };
+
+    if ( groupPoints.radius )
+      computeContainer( *gridPolyContainer( groupPoints, grid ) );
+    else
+      computeContainer( *gridContainer( groupPoints, grid ) );
+  };
+
+  // Compute voronoi cells
+  if ( !groups )
+    computeGroup( nullptr, 0, threads, true );
+
+  else
+  {
+    // Groups of at least 2 points from the largest to the smallest. Groups
+    // holding a large share of the points are computed one after the other
+    // on all threads, the others concurrently on one thread each.
+    std::vector< const std::vector< size_t >* > order;
+    for ( const std::vector< size_t >& members : groups->members )
+    {
+      if ( members.size() >= 2 )
+        order.push_back( &members );
+    }
+
+    std::stable_sort( order.begin(), order.end(),
+                      []( const std::vector< size_t >* a,
+                          const std::vector< size_t >* b )
+    {
+      return a->size() > b->size();
+    } );
+
+    size_t large = 0;
+    while ( large < order.size() && order[large]->size() * threads >= n &&
+            threads > 1 )
+    {
+      computeGroup( order[large], 0, threads, large == 0 );
+      large++;
+    }
+
+    parallelFor( order.size() - large, threads, [&]( int item, int thread )
+    {
+      computeGroup( order[large + item], thread, 1, large + item == 0 );
+    } );
+  }
+
+  if ( buffer )
+    buffer->finish( ( n + STREAM_BATCH - 1 ) / STREAM_BATCH + 1 );
+
+  overall.lap( profile.total );
+
+  if ( Profiled )
+  {
+    profile.threads = threads;
+
+    for ( double bytes : scratch )
+      profile.scratchBytes += bytes;
+
+    for ( const WktWriter& writer : writers )
+      profile.scratchBytes += writer.scratchBytes();
+
+    for ( const RecordWriter& writer : records )
+      profile.scratchBytes += writer.scratchBytes();
+
+    for ( const std::string& batch : batches )
+      profile.scratchBytes += batch.capacity();
+
+    if ( buffer )
+    {
+      profile.scratchBytes += buffer->peakBytes();
+      profile.outputBytes += buffer->bytes();
+    }
+
+    for ( const std::string& text : output.wkt )
+      profile.outputBytes += text.size();
+
+    for ( const WalkChunk& chunk : output.walks )
+    {
+      profile.outputBytes += ( chunk.points.size() + chunk.vertices.size()
+                               + chunk.faceOrigins.size() ) * sizeof( double )
+        + ( chunk.faceVertices.size() + chunk.faceSizes.size() ) * sizeof( int );
+    }
+
+    for ( const std::vector< unsigned char >& binary : output.wkb )
+      profile.outputBytes += binary.size();
+
+    for ( const MeshChunk& chunk : output.chunks )
+    {
+      profile.outputBytes += chunk.vertices.size() * sizeof( double )
+        + ( chunk.faces.size() + chunk.faceSizes.size() + chunk.faceNeighbours.size() )
+          * sizeof( int );
+    }
+
+    profile.outputBytes += output.volume.size() * sizeof( double );
+
+    for ( const AdjacencyChunk& chunk : output.adjacency )
+    {
+      profile.outputBytes += chunk.neighbours.size() * sizeof( int )
+        + chunk.areas.size() * sizeof( double );
+    }
+
+    for ( const BlockChunk& chunk : output.blocks )
+    {
+      profile.outputBytes += chunk.blocks.size() * sizeof( int )
+        + chunk.volumes.size() * sizeof( double );
+    }
+  }
+}
+
+void computeOutput( const Points& points,
+                    const CellOptions& options,
+                    CellOutput& output )
+{
+  checkOptions( points, options );
+
+  if ( options.profile )
+    computeOutputAs< true >( points, nullptr, options, output );
+  else
+    computeOutputAs< false >( points, nullptr, options, output );
+}
+
+void computeOutput( const Points& points,
+                    const PointGroups& groups,
+                    const CellOptions& options,
+                    CellOutput& output )
+{
+  checkOptions( points, options );
+
+  if ( options.profile )
+    computeOutputAs< true >( points, &groups, options, output );
+  else
+    computeOutputAs< false >( points, &groups, options, output );
+}
+
+void streamOutput( const Points& points,
+                   const CellOptions& options,
+                   const CellStream& stream,
+                   CellOutput& output )
+{
+  CellOptions streamOptions = options;
+  streamOptions.output = OUTPUT_WKT;
+  streamOptions.deferText = false;
+  checkOptions( points, streamOptions );
+
+  if ( options.profile )
+    computeOutputAs< true >( points, nullptr, streamOptions, output, &stream );
+  else
+    computeOutputAs< false >( points, nullptr, streamOptions, output, &stream );
+}
@@ -0,0 +1,445 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <voro++.hh>
+
+#include "anisotropy.h"
+#include "blockModel.h"
+#include "cellMesh.h"
+#include "cellStream.h"
+#include "dem.h"
+#include "grid.h"
+#include "influence.h"
+#include "parallel.h"
+#include "profile.h"
+#include "walls.h"
+
+// Core of voro3d. Everything declared here is plain C++17 without R, so it is
+// shared by the R package, the C API in voro3d.h and the command-line tool.
+// Invalid arguments are reported by throwing std::invalid_argument.
+
+// Coordinates of `n` points, stored as separate arrays
+struct Points
+{
+  const double* x;
+  const double* y;
+  const double* z;
+  size_t n;
+
+  // If not null, the points are read through this map
+  const Anisotropy* anisotropy = nullptr;
+
+  // If not null, the radius of each point, whose cells are then those of the
+  // power (Laguerre) diagram
+  const double* radius = nullptr;
+
+  // Coordinates of point `i`, mapped by `anisotropy`
+  void at( size_t i, double* position ) const
+  {
+    if ( anisotropy )
+      anisotropy->forward( x[i], y[i], z[i], position );
+    else
+    {
+      position[0] = x[i];
+      position[1] = y[i];
+      position[2] = z[i];
+    }
+  }
+};
+
+// Formats of the cells computed by `computeOutput()`
+enum OutputFormat
+{
+  OUTPUT_WKT,
+  OUTPUT_WKB,
+  OUTPUT_MESH,
+  OUTPUT_VOLUME,
+  OUTPUT_ADJACENCY,
+  OUTPUT_BLOCKS,
+
+  // Mesh of each cell, whose faces are polygons with the neighbour of each
+  // face, and its volume, as kept by `Diagram`. Not available by name.
+  OUTPUT_CELLS
+};
+
+// Format named "wkt", "wkb", "mesh", "volume", "adjacency" or "blocks"
+OutputFormat outputFormat( const std::string& name );
+
+// Settings of a run
+struct CellOptions
+{
+  // Ratio between the length of the container and the length of the bounding
+  // box of the points
+  double containerRatio = 1;
+
+  // Division of the container into blocks
+  GridOptions grid;
+
+  // Walls bounding the cells within the container
+  Walls walls;
+
+  // Ellipsoid around each point beyond which its cell is clipped, unless
+  // empty
+  Ellipsoid influence;
+
+  // Ellipsoid of the continuity of the data, unless empty. The cells are
+  // computed in the space where it is a sphere and mapped back.
+  Ellipsoid anisotropy;
+
+  // Terrain above which cells are clipped, unless empty
+  Dem dem;
+
+  // Blocks by which the cells are split for OUTPUT_BLOCKS
+  BlockModel blockModel;
+
+  // Number of threads used to compute the cells
+  int threads = 1;
+
+  OutputFormat output = OUTPUT_WKT;
+
+  // Write each face as one polygon instead of a fan of triangles
+  bool polygons = false;
+
+  // Number of decimals of coordinates in well-known text. Negative for the
+  // shortest text that reads back to the same number.
+  int precision = 6;
+
+  // For OUTPUT_WKT, keep the walked mesh of each cell instead of its text,
+  // so that the text can be written later, e.g. by `LazyWkt`
+  bool deferText = false;
+
+  // Measure the time spent in each phase
+  bool profile = false;
+};
+
+// Check the points and options shared by all runs
+void checkOptions( const Points& points, const CellOptions& options );
+
+// If ever x  is too small, use a threshold value for the dimensions of the
+// container.
+double setThreshold( double x );
+
+// Container holding all the points. The container is larger than the
+// bounding box of the points by `containerRatio` and its blocks are chosen by
+// `grid`.
+std::unique_ptr< voro::container > pointContainer( const Points& points,
+                                                   double containerRatio,
+                                                   const GridOptions& grid = GridOptions() );
+
+// Scratch space owned by one worker thread. Every thread gets its own cell
+// and mesh buffers so that cells can be computed concurrently from a shared,
+// read-only container.
+struct CellWorker
+{
+  voro::voronoicell vc;
+  CellMesh mesh;
+  FaceList faces;
+  ThreadProfile profile;
+
+  // Cell with the neighbour of each face and its faces, for the adjacency
+  voro::voronoicell_neighbor neighbourCell;
+  std::vector< int > neighbours;
+  std::vector< double > areas, normals;
+
+  // Approximate bytes of scratch space held by the worker. Buffers only
+  // grow, so this is also the peak over the cells computed so far.
+  size_t scratchBytes() const;
+};
+
+typedef std::vector< std::unique_ptr< CellWorker > > CellWorkers;
+
+// One worker per thread
+CellWorkers cellWorkers( int threads );
+
+// Compute the cell of every particle in `con`, with one thread per worker.
+// The blocks of the container are distributed among the threads and, for
+// each cell that could be computed, `store( worker, id, position, thread )` is
+// called with the cell in `worker.vc`. Since each cell is passed with its
+// particle id, the result of storing by id is the same as computing the cells
+// in input order on a single thread. Each thread searches the neighbours with
+// its own voro++ search object, for either kind of container. If
+// `neighbours` is true, the cells are computed in `worker.neighbourCell`
+// instead. If `Profiled` is true, the time spent in compute_cell() and the
+// number of cells are added to the profile of each worker.
+template < bool Profiled = false, class Container, class Store >
+void computeCells( Container& con, CellWorkers& workers, Store store,
+                   bool neighbours = false )
+{
+  std::vector< std::unique_ptr< voro::voro_compute< Container > > > computes;
+  for ( size_t t = 0; t < workers.size(); t++ )
+    computes.emplace_back( new voro::voro_compute< Container >( con, con.nx, con.ny, con.nz ) );
+
+  parallelFor( con.nxyz, workers.size(), [&]( int ijk, int thread )
+  {
+    CellWorker& worker = *workers[thread];
+    voro::voro_compute< Container >& compute = *computes[thread];
+    Stopwatch< Profiled > stopwatch;
+    int k = ijk / con.nxy;
+    int j = ( ijk - k * con.nxy ) / con.nx;
+    int i = ijk - con.nx * ( j + con.ny * k );
+
+    for ( int q = 0; q < con.co[ijk]; q++ )
+    {
+      stopwatch.start();
+      bool computed = neighbours
+        ? compute.compute_cell( worker.neighbourCell, ijk, q, i, j, k )
+        : compute.compute_cell( worker.vc, ijk, q, i, j, k );
+      stopwatch.lap( worker.profile.compute );
+
+      if ( Profiled )
+      {
+        worker.profile.cells++;
+        if ( !computed )
+          worker.profile.failed++;
+      }
+
+      if ( computed )
+        store( worker, con.id[ijk][q], con.p[ijk] + con.ps * q, thread );
+    }
+  } );
+}
+
+// Compute the cell of every particle in `con` in the order of the particle
+// ids, which must be less than `count`. The ids from 0 to `count` are split into
+// batches of `batch` consecutive ids, handed out one at a time to the threads,
+// so that batches finish roughly in order. For each particle,
+// `store( worker, id, position, thread )` is called with the cell in
+// `worker.vc` if it could be computed, and with a null `position` otherwise,
+// including for the ids that are not in `con`;
+// after each batch, `done( batch, thread )` is called with the batch number.
+// Profiling is the same as in `computeCells()`.
+template < bool Profiled = false, class Container, class Store, class Done >
+void computeCellsInOrder( Container& con, CellWorkers& workers, size_t count,
+                          size_t batch, Store store, Done done )
+{
+  // Block and index in the block of each particle
+  std::vector< std::pair< int, int > > located ( count, std::make_pair( -1, 0 ) );
+  for ( int ijk = 0; ijk < con.nxyz; ijk++ )
+  {
+    for ( int q = 0; q < con.co[ijk]; q++ )
+      located[con.id[ijk][q]] = std::make_pair( ijk, q );
+  }
+
+  std::vector< std::unique_ptr< voro::voro_compute< Container > > > computes;
+  for ( size_t t = 0; t < workers.size(); t++ )
+    computes.emplace_back( new voro::voro_compute< Container >( con, con.nx, con.ny, con.nz ) );
+
+  size_t n = count;
+  int batches = int( ( n + batch - 1 ) / batch );
+  parallelFor( batches, workers.size(), [&]( int item, int thread )
+  {
+    CellWorker& worker = *workers[thread];
+    voro::voro_compute< Container >& compute = *computes[thread];
+    Stopwatch< Profiled > stopwatch;
+
+    for ( size_t id = item * batch; id < std::min( n, ( item + 1 ) * batch ); id++ )
+    {
+      int ijk = located[id].first, q = located[id].second;
+      if ( ijk < 0 )
+      {
+        store( worker, id, nullptr, thread );
+        continue;
+      }
+
+      int k = ijk / con.nxy;
+      int j = ( ijk - k * con.nxy ) / con.nx;
+      int i = ijk - con.nx * ( j + con.ny * k );
+
+      stopwatch.start();
+      bool computed = compute.compute_cell( worker.vc, ijk, q, i, j, k );
+      stopwatch.lap( worker.profile.compute );
+
+      if ( Profiled )
+      {
+        worker.profile.cells++;
+        if ( !computed )
+          worker.profile.failed++;
+      }
+
+      store( worker, id, computed ? con.p[ijk] + con.ps * q : nullptr, thread );
+    }
+
+    done( item, thread );
+  }, 1 );
+}
+
+// Cells written by one thread, stored back to back
+struct MeshChunk
+{
+  std::vector< double > vertices;
+  std::vector< int > faces;
+  std::vector< int > faceSizes;
+
+  // Neighbour of each face, for OUTPUT_CELLS
+  std::vector< int > faceNeighbours;
+};
+
+// Location of the cell of a particle within the chunk of the thread that
+// computed it. Face indices are 0-based and local to the cell.
+struct MeshSlot
+{
+  int thread = -1;
+  size_t vertex = 0, face = 0, faceSize = 0;
+  int vertices = 0, faces = 0, indices = 0;
+};
+
+// Append the vertices of `mesh` and its oriented `faces` to `chunk`
+void appendFaces( const CellMesh& mesh,
+                  const FaceList& faces,
+                  int thread,
+                  MeshChunk& chunk,
+                  MeshSlot& slot );
+
+// Meshes of the cells computed by one thread, stored back to back as they
+// were walked, so that they are written later exactly as they would have
+// been at once
+struct WalkChunk
+{
+  // Point from which the faces of each cell are oriented
+  std::vector< double > points;
+
+  std::vector< double > vertices;
+  std::vector< int > faceVertices;
+  std::vector< int > faceSizes;
+  std::vector< double > faceOrigins;
+};
+
+// Location of the mesh of a particle within the chunk of the thread that
+// walked it
+struct WalkSlot
+{
+  int thread = -1;
+  size_t point = 0, vertex = 0, index = 0, face = 0, faceOrigin = 0;
+  int vertices = 0, indices = 0, faces = 0;
+  bool origins = false;
+};
+
+// Append `mesh` to `chunk`
+void appendWalk( const CellMesh& mesh, int thread, WalkChunk& chunk, WalkSlot& slot );
+
+// Load the mesh stored at `slot` into `mesh`
+void loadWalk( const WalkChunk& chunk, const WalkSlot& slot, CellMesh& mesh );
+
+// Neighbours of the faces of the cells computed by one thread, with the area
+// of each face
+struct AdjacencyChunk
+{
+  std::vector< int > neighbours;
+  std::vector< double > areas;
+};
+
+// Location of the faces of the cell of a particle within the chunk of the
+// thread that computed it
+struct AdjacencySlot
+{
+  int thread = -1;
+  size_t face = 0;
+  int faces = 0;
+};
+
+// Blocks overlapped by the cells computed by one thread, with the volume of
+// each cell within each block
+struct BlockChunk
+{
+  std::vector< int > blocks;
+  std::vector< double > volumes;
+};
+
+// Location of the blocks of the cell of a particle within the chunk of the
+// thread that computed it
+struct BlockSlot
+{
+  int thread = -1;
+  size_t part = 0;
+  int parts = 0;
+};
+
+// Time and size of the phases of a profiled run. Times are in seconds;
+// `put`, `compute`, `walk` and `write` are summed over threads.
+struct RunProfile
+{
+  double put = 0, compute = 0, walk = 0, write = 0, total = 0;
+  double cells = 0, failed = 0, scratchBytes = 0, outputBytes = 0;
+  int threads = 1;
+
+  // Blocks of the container along x, y and z, of the largest group if the
+  // points are grouped
+  int blocks[3] = { 0, 0, 0 };
+};
+
+// Cells of all points in one format, indexed by particle id. Only the
+// members of the requested format are filled.
+struct CellOutput
+{
+  OutputFormat format = OUTPUT_WKT;
+
+  // Non-zero for the cells that could be computed
+  std::vector< char > computed;
+
+  std::vector< std::string > wkt;
+
+  // For OUTPUT_WKT with `CellOptions::deferText`, instead of `wkt`
+  std::vector< WalkChunk > walks;
+  std::vector< WalkSlot > walkSlots;
+
+  std::vector< std::vector< unsigned char > > wkb;
+  std::vector< MeshChunk > chunks;
+  std::vector< MeshSlot > slots;
+  std::vector< double > volume;
+
+  // For OUTPUT_ADJACENCY. Neighbours are particle ids, or the negative ids of
+  // voro++ for the sides of the container (-1 to -6) and of the walls.
+  std::vector< AdjacencyChunk > adjacency;
+  std::vector< AdjacencySlot > adjacencySlots;
+
+  // For OUTPUT_BLOCKS, the block indices of `BlockModel` overlapped by each
+  // cell, in increasing order
+  std::vector< BlockChunk > blocks;
+  std::vector< BlockSlot > blockSlots;
+
+  // Filled if `CellOptions::profile` is set
+  RunProfile profile;
+};
+
+// Compute the cells of `points` in the format of `options.output`
+void computeOutput( const Points& points,
+                    const CellOptions& options,
+                    CellOutput& output );
+
+// Compute the cells of `points` as `computeOutput()` does and write each of
+// them to `stream` as soon as it is computed, in the order of the points,
+// instead of storing them. The memory used is then bounded by the container
+// and `stream.bufferBytes` rather than by the cells. Only `output.computed`
+// and the profile are filled, whose `outputBytes` is the number of bytes
+// written. `options.output` is ignored. The file is flushed but not closed.
+void streamOutput( const Points& points,
+                   const CellOptions& options,
+                   const CellStream& stream,
+                   CellOutput& output );
+
+// Points split into groups whose diagrams are computed separately, e.g. the
+// samples of each geological domain
+struct PointGroups
+{
+  // Indices of the points of each group
+  std::vector< std::vector< size_t > > members;
+};
+
+// Group the points by `codes`, in the order in which the codes first appear.
+// Points with a negative code are in no group.
+PointGroups pointGroups( const int* codes, size_t n );
+
+// Compute the cells of each group of `points` in a container of its own, as
+// if `computeOutput()` was called on the points of each group. The cells of
+// points in no group or in a group of less than 2 points are not computed.
+// Groups are processed concurrently, so many small groups use all threads.
+void computeOutput( const Points& points,
+                    const PointGroups& groups,
+                    const CellOptions& options,
+                    CellOutput& output );
+
+#endif
@@ -0,0 +1,46 @@
+#include "geojson.h"
+
+void GeoJsonWriter::append( const CellMesh& mesh, bool polygons, std::string& json )
+{
+  int f, r, size, vertexCount = mesh.vertices.size() / 3;
+  const int* ring;
+
+  points.clear();
+  pointOffsets.clear();
+  pointOffsets.push_back( 0 );
+  for ( int v = 0; v < vertexCount; v++ )
+  {
+    points += '[';
+    format.append( points, mesh.vertices[3 * v] );
+    points += ',';
+    format.append( points, mesh.vertices[3 * v + 1] );
+    points += ',';
+    format.append( points, mesh.vertices[3 * v + 2] );
+    points += ']';
+    pointOffsets.push_back( points.size() );
+  }
+
+  mesh.orientedFaces( polygons, faces );
+
+  json += "{\"type\":\"MultiPolygon\",\"coordinates\":[";
+
+  for ( f = 0; f < faces.faces(); f++ )
+  {
+    ring = faces.vertices.data() + faces.offsets[f];
+    size = faces.offsets[f + 1] - faces.offsets[f];
+
+    if ( f > 0 )
+      json += ',';
+    json += "[[";
+    for ( r = 0; r <= size; r++ )
+    {
+      int v = ring[r % size];
+      if ( r > 0 )
+        json += ',';
+      json.append( points, pointOffsets[v], pointOffsets[v + 1] - pointOffsets[v] );
+    }
+    json += "]]";
+  }
+
+  json += "]}";
+}
@@ -0,0 +1,46 @@
+#ifndef GEOJSON_H
+#define GEOJSON_H
+
+#include <string>
+#include <vector>
+#include "cellMesh.h"
+#include "numberFormat.h"
+
+// Writes cells as GeoJSON geometries. GeoJSON has no polyhedral surface, so a
+// cell is written as a MultiPolygon of its faces with three coordinates per
+// position, each ring closed by repeating its first position. As in
+// `WktWriter`, the position of each vertex is formatted once per cell into a
+// buffer that is reused from cell to cell. A writer holds scratch space, so
+// each thread needs its own.
+class GeoJsonWriter
+{
+public:
+
+  explicit GeoJsonWriter( NumberFormat format = NumberFormat() ) :
+    format( format ) {}
+
+  // Append the geometry of `mesh` to `json`. Each face is written as one
+  // polygon, or as a fan of triangles if `polygons` is false.
+  void append( const CellMesh& mesh, bool polygons, std::string& json );
+
+  // Bytes of scratch space held by the writer
+  size_t scratchBytes() const
+  {
+    return points.capacity()
+      + pointOffsets.capacity() * sizeof( size_t )
+      + faces.bytes();
+  }
+
+private:
+
+  NumberFormat format;
+  FaceList faces;
+
+  // Position of each vertex of the current cell as a JSON array. Vertex `v`
+  // is stored from `pointOffsets[v]` up to `pointOffsets[v + 1]`.
+  std::string points;
+  std::vector< size_t > pointOffsets;
+
+};
+
+#endif
@@ -0,0 +1,437 @@
+#include <algorithm>
+#include <climits>
+#include <math.h>
+#include <stdexcept>
+#include <stdint.h>
+#include "engine.h"
+#include "grid.h"
+
+// Mean number of points per block of the uniform grid
+static const double pointsPerBlock = 5.6;
+
+// Number of points in the block of a point, averaged over the points, for
+// points spread uniformly over blocks of `pointsPerBlock`
+static const double targetOccupancy = pointsPerBlock + 1;
+
+// Largest sample of points used to measure the occupancy of a grid
+static const size_t sampleSize = 65536;
+
+GridMode gridMode( const std::string& name )
+{
+  if ( name == "uniform" )
+    return GRID_UNIFORM;
+  if ( name == "tuned" )
+    return GRID_TUNED;
+  if ( name == "anisotropic" )
+    return GRID_ANISOTROPIC;
+
+  throw std::invalid_argument(
+    "Invalid grid: Value must be \"uniform\", \"tuned\" or \"anisotropic\"." );
+}
+
+void checkGrid( const GridOptions& grid )
+{
+  const int* blocks = grid.blocks;
+  bool automatic = blocks[0] == 0 && blocks[1] == 0 && blocks[2] == 0;
+
+  if ( !automatic && ( blocks[0] < 1 || blocks[1] < 1 || blocks[2] < 1 ) )
+    throw std::invalid_argument( "Invalid blocks: Value must be three positive integers." );
+
+  if ( double( blocks[0] ) * blocks[1] * blocks[2] > INT_MAX )
+    throw std::invalid_argument( "Invalid blocks: Too many blocks." );
+
+  if ( grid.initMem < 0 )
+    throw std::invalid_argument( "Invalid initMem: Value must not be less than 0." );
+}
+
+// Index of the block of (x, y, z) in the block order of voro++, or -1 if the
+// point is outside of the container. Blocks are located with the same
+// arithmetic as container_base::put_remap(), step_int( ( x - ax ) * xsp ),
+// where voro_base sets xsp = 1 / boxx from the block width
+// boxx = ( bx - ax ) / nx, so that the counts are exactly the particles that
+// put() adds to each block.
+class BlockLocator
+{
+public:
+  BlockLocator( const double* low, const double* high, const int* blocks )
+  {
+    for ( int a = 0; a < 3; a++ )
+    {
+      this->low[a] = low[a];
+      this->blocks[a] = blocks[a];
+      inverse[a] = 1 / ( ( high[a] - low[a] ) / blocks[a] );
+    }
+  }
+
+  int64_t operator()( double x, double y, double z ) const
+  {
+    double position[3] = { x, y, z };
+    int64_t index = 0;
+
+    for ( int a = 2; a >= 0; a-- )
+    {
+      // Within [0, blocks), step_int() truncates like int(), and outside of
+      // it both reject the point
+      double step = ( position[a] - low[a] ) * inverse[a];
+      if ( !( step >= 0 && step < blocks[a] ) )
+        return -1;
+      index = index * blocks[a] + int( step );
+    }
+
+    return index;
+  }
+
+private:
+  double low[3], inverse[3];
+  int blocks[3];
+};
+
+// Points used to measure the occupancy of candidate grids
+struct GridSample
+{
+  std::vector< double > x, y, z;
+  double fraction;
+};
+
+// Sample of about `sampleSize` points. Points are picked by a hash of their
+// index rather than at a fixed stride, which could line up with the spacing
+// of regularly sampled data such as drill hole composites.
+static GridSample gridSample( const Points& points )
+{
+  GridSample sample;
+  double probability = std::min( 1.0, double( sampleSize ) / points.n );
+  uint64_t threshold = uint64_t( probability * 18446744073709549568.0 );
+
+  for ( size_t i = 0; i < points.n; i++ )
+  {
+    // splitmix64 finalizer
+    uint64_t hash = i + 0x9e3779b97f4a7c15ULL;
+    hash = ( hash ^ ( hash >> 30 ) ) * 0xbf58476d1ce4e5b9ULL;
+    hash = ( hash ^ ( hash >> 27 ) ) * 0x94d049bb133111ebULL;
+    hash ^= hash >> 31;
+
+    if ( probability < 1 && hash >= threshold )
+      continue;
+
+    double position[3];
+    points.at( i, position );
+    sample.x.push_back( position[0] );
+    sample.y.push_back( position[1] );
+    sample.z.push_back( position[2] );
+  }
+
+  sample.fraction = double( sample.x.size() ) / points.n;
+  return sample;
+}
+
+// Number of points in the block of a point, averaged over all points and
+// estimated from `sample`. A point shares its block with each of the other
+// points of the block, which are in the sample with probability
+// `sample.fraction`.
+static double occupancy( const GridSample& sample,
+                         const ContainerGrid& grid,
+                         const int* blocks,
+                         std::vector< int64_t >& keys )
+{
+  BlockLocator locate ( grid.low, grid.high, blocks );
+  keys.clear();
+
+  for ( size_t i = 0; i < sample.x.size(); i++ )
+  {
+    int64_t key = locate( sample.x[i], sample.y[i], sample.z[i] );
+    if ( key >= 0 )
+      keys.push_back( key );
+  }
+
+  if ( keys.empty() )
+    return 1;
+
+  std::sort( keys.begin(), keys.end() );
+
+  double squares = 0;
+  for ( size_t start = 0, end; start < keys.size(); start = end )
+  {
+    for ( end = start + 1; end < keys.size() && keys[end] == keys[start]; end++ );
+    double count = end - start;
+    squares += count * count;
+  }
+
+  return 1 + ( squares / keys.size() - 1 ) / sample.fraction;
+}
+
+static double blockCount( const int* blocks )
+{
+  return double( blocks[0] ) * blocks[1] * blocks[2];
+}
+
+// Scale the cubic blocks of `grid` until the occupancy is close to the
+// target. The occupancy in excess of the point itself grows as a power of the
+// block length, 3 for points filling the volume and 1 for points along
+// lines, and the exponent is estimated from the steps taken so far.
+static void tuneCubic( const GridSample& sample, double maxBlocks,
+                       ContainerGrid& grid )
+{
+  std::vector< int64_t > keys;
+  int blocks[3] = { grid.blocks[0], grid.blocks[1], grid.blocks[2] };
+  double current = occupancy( sample, grid, blocks, keys );
+  double exponent = 3;
+  double best = fabs( log( current / targetOccupancy ) );
+
+  for ( int step = 0; step < 8 && best > log( 1.25 ); step++ )
+  {
+    double scale = pow( ( current - 1 ) / ( targetOccupancy - 1 ), 1 / exponent );
+    scale = std::min( std::max( scale, 0.25 ), 8.0 );
+
+    int trial[3];
+    for ( int a = 0; a < 3; a++ )
+      trial[a] = std::max( 1, int( blocks[a] * scale + 0.5 ) );
+
+    if ( blockCount( trial ) > maxBlocks )
+    {
+      double shrink = cbrt( maxBlocks / blockCount( trial ) );
+      for ( int a = 0; a < 3; a++ )
+        trial[a] = std::max( 1, int( trial[a] * shrink ) );
+    }
+
+    if ( std::equal( trial, trial + 3, blocks ) )
+      break;
+
+    double next = occupancy( sample, grid, trial, keys );
+    double ratio = blockCount( trial ) / blockCount( blocks );
+    if ( next > 1 && current > 1 && ratio != 1 )
+    {
+      exponent = 3 * log( ( current - 1 ) / ( next - 1 ) ) / log( ratio );
+      exponent = std::min( std::max( exponent, 0.5 ), 3.0 );
+    }
+
+    current = next;
+    std::copy( trial, trial + 3, blocks );
+    if ( fabs( log( current / targetOccupancy ) ) < best )
+    {
+      best = fabs( log( current / targetOccupancy ) );
+      std::copy( blocks, blocks + 3, grid.blocks );
+    }
+  }
+}
+
+// Halve the blocks of `grid` along the axis that lowers the occupancy most
+// until it meets the target, then merge blocks along the axes that keep it
+// there. Ties go to the axis with the longest blocks, so that the blocks stay
+// as cubic as the points allow.
+static void tuneAnisotropic( const GridSample& sample, double maxBlocks,
+                             ContainerGrid& grid )
+{
+  const double limit = 1.25 * targetOccupancy;
+  std::vector< int64_t > keys;
+  double current = occupancy( sample, grid, grid.blocks, keys );
+
+  for ( int refine = 1; refine >= 0; refine-- )
+  {
+    for ( int step = 0; step < 64; step++ )
+    {
+      if ( refine && current <= limit )
+        break;
+
+      int bestAxis = -1;
+      double bestOccupancy = 0, bestLength = 0;
+
+      for ( int a = 0; a < 3; a++ )
+      {
+        int trial[3] = { grid.blocks[0], grid.blocks[1], grid.blocks[2] };
+        trial[a] = refine ? 2 * trial[a] : ( trial[a] + 1 ) / 2;
+        if ( trial[a] == grid.blocks[a] || blockCount( trial ) > maxBlocks )
+          continue;
+
+        double next = occupancy( sample, grid, trial, keys );
+        double length = ( grid.high[a] - grid.low[a] ) / grid.blocks[a];
+        bool preferred = refine ? length > bestLength : length < bestLength;
+        bool better = bestAxis < 0 || next < 0.95 * bestOccupancy ||
+          ( next < bestOccupancy / 0.95 && preferred );
+
+        if ( better )
+        {
+          bestAxis = a;
+          bestOccupancy = next;
+          bestLength = length;
+        }
+      }
+
+      // Stop refining once no split separates the points and stop merging
+      // before the target is exceeded
+      if ( bestAxis < 0 || ( refine && bestOccupancy > 0.97 * current ) ||
+           ( !refine && bestOccupancy > limit ) )
+        break;
+
+      grid.blocks[bestAxis] = refine ? 2 * grid.blocks[bestAxis]
+                                     : ( grid.blocks[bestAxis] + 1 ) / 2;
+      current = bestOccupancy;
+    }
+  }
+}
+
+void containerBounds( const double* min, const double* max, double containerRatio,
+                      double* low, double* high )
+{
+  for ( int a = 0; a < 3; a++ )
+  {
+    // Bounding box dimensions, and container vertices with a margin based on
+    // the ratio (multiplying factor)
+    double length = setThreshold( max[a] - min[a] );
+    double margin = length * ( containerRatio - 1 ) / 2;
+    low[a] = min[a] - margin;
+    high[a] = max[a] + margin;
+  }
+}
+
+ContainerGrid containerGrid( const Points& points,
+                             double containerRatio,
+                             const GridOptions& options )
+{
+  ContainerGrid grid;
+  double length[3], min[3], max[3], position[3];
+  size_t n = points.n;
+
+  // Bounding box vertices
+  points.at( 0, min );
+  points.at( 0, max );
+  for ( size_t i = 1; i < n; i++ )
+  {
+    points.at( i, position );
+    for ( int a = 0; a < 3; a++ )
+    {
+      min[a] = std::min( min[a], position[a] );
+      max[a] = std::max( max[a], position[a] );
+    }
+  }
+
+  if ( options.bounded )
+  {
+    std::copy( options.low, options.low + 3, grid.low );
+    std::copy( options.high, options.high + 3, grid.high );
+    for ( int a = 0; a < 3; a++ )
+      length[a] = setThreshold( grid.high[a] - grid.low[a] );
+  }
+
+  else
+  {
+    containerBounds( min, max, containerRatio, grid.low, grid.high );
+    for ( int a = 0; a < 3; a++ )
+      length[a] = setThreshold( max[a] - min[a] );
+  }
+
+  // Number of divisions per axis
+  double cells = cbrt( n / ( pointsPerBlock * length[0] * length[1] * length[2] ) );
+  for ( int a = 0; a < 3; a++ )
+    grid.blocks[a] = int( length[a] * cells + 1 );
+
+  bool manualBlocks = options.blocks[0] > 0;
+  if ( manualBlocks )
+    std::copy( options.blocks, options.blocks + 3, grid.blocks );
+
+  if ( options.initMem > 0 )
+    grid.initMem = options.initMem;
+
+  if ( options.mode == GRID_UNIFORM )
+    return grid;
+
+  if ( !manualBlocks )
+  {
+    GridSample sample = gridSample( points );
+    double maxBlocks = std::max( 27.0, double( n ) );
+
+    if ( options.mode == GRID_TUNED )
+      tuneCubic( sample, maxBlocks, grid );
+    else
+      tuneAnisotropic( sample, maxBlocks, grid );
+  }
+
+  if ( options.initMem == 0 )
+  {
+    BlockLocator locate ( grid.low, grid.high, grid.blocks );
+    grid.counts.assign( grid.blocks[0] * grid.blocks[1] * grid.blocks[2], 0 );
+
+    for ( size_t i = 0; i < n; i++ )
+    {
+      points.at( i, position );
+      int64_t block = locate( position[0], position[1], position[2] );
+      if ( block >= 0 )
+        grid.counts[block]++;
+    }
+  }
+
+  return grid;
+}
+
+static void putPoint( voro::container& con, const Points&, size_t i,
+                      const double* position )
+{
+  con.put( i, position[0], position[1], position[2] );
+}
+
+static void putPoint( voro::container_poly& con, const Points& points, size_t i,
+                      const double* position )
+{
+  con.put( i, position[0], position[1], position[2], points.radius[i] );
+}
+
+// Add the points to `con`, created with the bounds and blocks of `grid`
+template < class Container >
+static void fillContainer( Container& con, const Points& points,
+                           const ContainerGrid& grid )
+{
+  // Size the memory of each block for its particles, so that no block is
+  // reallocated while the points are added. The counts of BlockLocator are
+  // those of put(); were one short, put() would still grow the block through
+  // add_particle_memory(), which frees the arrays with delete[] as here.
+  for ( size_t block = 0; block < grid.counts.size(); block++ )
+  {
+    int count = grid.counts[block];
+    if ( count > 1 )
+    {
+      delete[] con.id[block];
+      delete[] con.p[block];
+      con.id[block] = new int[count];
+      con.p[block] = new double[con.ps * count];
+      con.mem[block] = count;
+    }
+  }
+
+  // Add points to container
+  for ( size_t i = 0; i < points.n; i++ )
+  {
+    double position[3];
+    points.at( i, position );
+    putPoint( con, points, i, position );
+  }
+}
+
+std::unique_ptr< voro::container > gridContainer( const Points& points,
+                                                  const ContainerGrid& grid )
+{
+  // Initialize container
+  std::unique_ptr< voro::container > con (
+    new voro::container( grid.low[0], grid.high[0],
+                         grid.low[1], grid.high[1],
+                         grid.low[2], grid.high[2],
+                         grid.blocks[0], grid.blocks[1], grid.blocks[2],
+                         false, false, false,
+                         grid.counts.empty() ? grid.initMem : 1 ) );
+
+  fillContainer( *con, points, grid );
+  return con;
+}
+
+std::unique_ptr< voro::container_poly > gridPolyContainer( const Points& points,
+                                                           const ContainerGrid& grid )
+{
+  std::unique_ptr< voro::container_poly > con (
+    new voro::container_poly( grid.low[0], grid.high[0],
+                              grid.low[1], grid.high[1],
+                              grid.low[2], grid.high[2],
+                              grid.blocks[0], grid.blocks[1], grid.blocks[2],
+                              false, false, false,
+                              grid.counts.empty() ? grid.initMem : 1 ) );
+
+  fillContainer( *con, points, grid );
+  return con;
+}
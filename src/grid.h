@@ -0,0 +1,91 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include <memory>
+#include <string>
+#include <vector>
+#include <voro++.hh>
+
+struct Points;
+
+// How the container is divided into blocks
+enum GridMode
+{
+  // Cubic blocks sized for uniformly distributed points
+  GRID_UNIFORM,
+  // Cubic blocks sized from the occupancy of the blocks
+  GRID_TUNED,
+  // Blocks sized per axis from the occupancy of the blocks
+  GRID_ANISOTROPIC
+};
+
+// Mode named "uniform", "tuned" or "anisotropic"
+GridMode gridMode( const std::string& name );
+
+// Settings of the container grid. The manual overrides are meant for
+// benchmarking and take precedence over the mode.
+struct GridOptions
+{
+  GridMode mode = GRID_UNIFORM;
+
+  // Number of blocks along x, y and z, or zeros to choose them by `mode`
+  int blocks[3] = { 0, 0, 0 };
+
+  // Initial number of particles that each block can hold, or 0 to choose it
+  // by `mode`
+  int initMem = 0;
+
+  // If set, the container spans the box from `low` to `high`, which must hold
+  // the points, instead of their bounding box enlarged by the container
+  // ratio, e.g. to compute some cells of a larger diagram
+  bool bounded = false;
+  double low[3] = { 0, 0, 0 }, high[3] = { 0, 0, 0 };
+};
+
+// Check the manual overrides of `grid`
+void checkGrid( const GridOptions& grid );
+
+// Bounds and blocks of a container
+struct ContainerGrid
+{
+  double low[3], high[3];
+  int blocks[3];
+
+  // Initial number of particles that each block can hold
+  int initMem = 8;
+
+  // Number of particles in each block, in the block order of voro++. If not
+  // empty, the memory of each block is sized from it instead of `initMem`.
+  std::vector< int > counts;
+};
+
+// Bounds `low` and `high` of a container larger than the bounding box from
+// `min` to `max` by `containerRatio`, as used by `containerGrid()`. Lengths
+// below the threshold of `setThreshold()` are raised to it first.
+void containerBounds( const double* min, const double* max, double containerRatio,
+                      double* low, double* high );
+
+// Grid of a container larger than the bounding box of `points` by
+// `containerRatio`.
+//
+// GRID_UNIFORM uses about 5.6 points per block of the bounding box. The other
+// modes start from that grid and measure the number of points in the block of
+// each point, which is what the cell computation pays for, from a histogram of
+// a sample of the points. GRID_TUNED scales the cubic blocks until that
+// number is close to the one of uniformly distributed points. GRID_ANISOTROPIC
+// instead halves the blocks along the axis that separates the points best,
+// e.g. along the holes of drill hole composites, until the target is met.
+// Both count the points in each block of the final grid.
+ContainerGrid containerGrid( const Points& points,
+                             double containerRatio,
+                             const GridOptions& options );
+
+// Container with the bounds and blocks of `grid`, holding all the points
+std::unique_ptr< voro::container > gridContainer( const Points& points,
+                                                  const ContainerGrid& grid );
+
+// Same as above with the radii of `points`, for the cells of the power diagram
+std::unique_ptr< voro::container_poly > gridPolyContainer( const Points& points,
+                                                           const ContainerGrid& grid );
+
+#endif
@@ -0,0 +1,132 @@
+#include <algorithm>
+#include <math.h>
+#include "influence.h"
+
+// Number of tangent planes of the polyhedron
+static const int planeCount = 192;
+
+InfluenceWall::InfluenceWall( const Ellipsoid& ellipsoid, const double* offsetMap )
+{
+  double axes[3][3];
+  ellipsoidAxes( ellipsoid, axes );
+  for ( int a = 0; a < 3; a++ )
+  {
+    for ( int b = 0; b < 3; b++ )
+    {
+      unit[a][b] = 0;
+      for ( int c = 0; c < 3; c++ )
+      {
+        double map = offsetMap ? offsetMap[3 * c + b] : c == b;
+        unit[a][b] += axes[a][c] * map / ellipsoid.ranges[a];
+      }
+    }
+  }
+
+  // Directions of a spherical Fibonacci lattice, spread evenly over the
+  // sphere
+  std::vector< double > directions;
+  const double golden = M_PI * ( 3 - sqrt( 5.0 ) );
+  for ( int i = 0; i < planeCount; i++ )
+  {
+    double z = 1 - ( 2 * i + 1.0 ) / planeCount;
+    double r = sqrt( 1 - z * z );
+    directions.push_back( r * cos( golden * i ) );
+    directions.push_back( r * sin( golden * i ) );
+    directions.push_back( z );
+  }
+
+  // Polyhedron of the planes tangent to the unit sphere, scaled to the
+  // volume of the sphere
+  voro::voronoicell sphere;
+  sphere.init( -2, 2, -2, 2, -2, 2 );
+  for ( int i = 0; i < planeCount; i++ )
+    sphere.plane( directions[3 * i], directions[3 * i + 1], directions[3 * i + 2], 2 );
+
+  inner = cbrt( 4 * M_PI / 3 / sphere.volume() );
+
+  std::vector< double > vertices;
+  sphere.vertices( vertices );
+  double outer = 0;
+  for ( size_t v = 0; v < vertices.size(); v += 3 )
+  {
+    outer = std::max( outer, vertices[v] * vertices[v] + vertices[v + 1] * vertices[v + 1]
+                             + vertices[v + 2] * vertices[v + 2] );
+  }
+  box = inner * sqrt( outer ) * ( 1 + 1e-9 );
+
+  // The plane of direction u keeps the offsets d from the point with
+  // u . ( unit d ) <= inner
+  for ( int i = 0; i < planeCount; i++ )
+  {
+    double normal[3] = { 0, 0, 0 };
+    for ( int a = 0; a < 3; a++ )
+    {
+      for ( int b = 0; b < 3; b++ )
+        normal[b] += directions[3 * i + a] * unit[a][b];
+    }
+
+    double length = sqrt( normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2] );
+    for ( int b = 0; b < 3; b++ )
+      planes.push_back( normal[b] / length );
+    planes.push_back( 2 * inner / length );
+  }
+}
+
+template < class Cell >
+bool InfluenceWall::cutBox( Cell& c ) const
+{
+  for ( int a = 0; a < 3; a++ )
+  {
+    const double* row = unit[a];
+    double length = sqrt( row[0] * row[0] + row[1] * row[1] + row[2] * row[2] );
+    for ( double sign : { 1.0, -1.0 } )
+    {
+      if ( !c.nplane( sign * row[0] / length, sign * row[1] / length,
+                      sign * row[2] / length, 2 * box / length, influenceId ) )
+        return false;
+    }
+  }
+
+  return true;
+}
+
+bool InfluenceWall::cut_cell( voro::voronoicell& c, double, double, double )
+{
+  return cutBox( c );
+}
+
+bool InfluenceWall::cut_cell( voro::voronoicell_neighbor& c, double, double, double )
+{
+  return cutBox( c );
+}
+
+template < class Cell >
+bool InfluenceWall::clipCell( Cell& c ) const
+{
+  // Largest distance of a vertex from the point where the ellipsoid is the
+  // unit sphere. The vertices are stored at twice their offset from the
+  // point.
+  double largest = 0;
+  for ( int k = 0; k < c.p; k++ )
+  {
+    const double* vertex = c.pts + 3 * k;
+    double distance = 0;
+    for ( int a = 0; a < 3; a++ )
+    {
+      double s = unit[a][0] * vertex[0] + unit[a][1] * vertex[1] + unit[a][2] * vertex[2];
+      distance += s * s;
+    }
+    largest = std::max( largest, distance );
+  }
+
+  if ( largest <= 4 * inner * inner )
+    return true;
+
+  for ( size_t i = 0; i < planes.size(); i += 4 )
+  {
+    if ( !c.nplane( planes[i], planes[i + 1], planes[i + 2], planes[i + 3], influenceId ) )
+      return false;
+  }
+
+  return true;
+}
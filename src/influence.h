@@ -0,0 +1,58 @@
+#ifndef INFLUENCE_H
+#define INFLUENCE_H
+
+#include <vector>
+#include <voro++.hh>
+
+#include "ellipsoid.h"
+
+// Neighbour id of the faces cut by the influence ellipsoid
+const int influenceId = -1000002;
+
+// Bounds every cell by an ellipsoid centred on its point. The ellipsoid is
+// approximated by a polyhedron of tangent planes, scaled to the volume of the
+// ellipsoid, whose surface is within 1.5% of the ellipsoid along any ray from
+// its center.
+//
+// As a voro++ wall, it cuts each cell by the box around the polyhedron before
+// the neighbours are searched, so that the search stops at the box. Once the
+// cell is computed, `clip()` cuts it by the polyhedron; cells within the
+// sphere inscribed in the polyhedron are left as they are. The object must
+// outlive the containers it is added to and may be shared between threads.
+//
+// If `offsetMap` is not null, the cells are computed in a space whose offsets
+// from the points it maps, by rows, to the space of the ellipsoid.
+class InfluenceWall : public voro::wall
+{
+public:
+  explicit InfluenceWall( const Ellipsoid& ellipsoid,
+                          const double* offsetMap = nullptr );
+
+  bool point_inside( double, double, double ) override { return true; }
+  bool cut_cell( voro::voronoicell& c, double x, double y, double z ) override;
+  bool cut_cell( voro::voronoicell_neighbor& c, double x, double y, double z ) override;
+
+  // Cut the computed cell `c` by the polyhedron. Returns false if nothing is
+  // left.
+  bool clip( voro::voronoicell& c ) const { return clipCell( c ); }
+  bool clip( voro::voronoicell_neighbor& c ) const { return clipCell( c ); }
+
+private:
+  // Map of the offsets from the point to a space where the ellipsoid is the
+  // unit sphere
+  double unit[3][3];
+
+  // Distance of the tangent planes and half-width of the box in that space
+  double inner, box;
+
+  // Unit normal and voro++ rsq of each plane of the polyhedron
+  std::vector< double > planes;
+
+  template < class Cell >
+  bool cutBox( Cell& c ) const;
+
+  template < class Cell >
+  bool clipCell( Cell& c ) const;
+};
+
+#endif
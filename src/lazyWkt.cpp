@@ -0,0 +1,57 @@
+#include <stdexcept>
+#include "lazyWkt.h"
+
+LazyWkt::LazyWkt( CellOutput&& output, bool polygons, int precision )
+  : cells( std::move( output ) ),
+    polygons( polygons ),
+    format( precision ),
+    writer( format )
+{
+  if ( cells.format != OUTPUT_WKT || cells.walkSlots.size() != cells.computed.size() )
+    throw std::invalid_argument( "Invalid output: The cells must be computed with deferred text." );
+}
+
+void LazyWkt::load( size_t id, CellMesh& mesh ) const
+{
+  const WalkSlot& slot = cells.walkSlots[id];
+  loadWalk( cells.walks[slot.thread], slot, mesh );
+}
+
+void LazyWkt::write( size_t id, std::string& wkt )
+{
+  load( id, mesh );
+  writer.write( mesh, polygons, wkt );
+}
+
+void LazyWkt::write( const std::vector< size_t >& ids,
+                     int threads,
+                     std::vector< std::string >& texts ) const
+{
+  texts.assign( ids.size(), std::string() );
+  std::vector< WktWriter > writers ( threads, WktWriter( format ) );
+  std::vector< CellMesh > meshes ( threads );
+
+  parallelFor( int( ids.size() ), threads, [&]( int item, int thread )
+  {
+    if ( !computed( ids[item] ) )
+      return;
+
+    load( ids[item], meshes[thread] );
+    writers[thread].write( meshes[thread], polygons, texts[item] );
+  } );
+}
+
+size_t LazyWkt::bytes() const
+{
+  size_t total = cells.computed.capacity()
+    + cells.walkSlots.capacity() * sizeof( WalkSlot );
+
+  for ( const WalkChunk& chunk : cells.walks )
+  {
+    total += ( chunk.points.capacity() + chunk.vertices.capacity()
+               + chunk.faceOrigins.capacity() ) * sizeof( double )
+      + ( chunk.faceVertices.capacity() + chunk.faceSizes.capacity() ) * sizeof( int );
+  }
+
+  return total;
+}
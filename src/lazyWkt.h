@@ -0,0 +1,55 @@
+#ifndef LAZY_WKT_H
+#define LAZY_WKT_H
+
+#include <string>
+#include <vector>
+
+#include "engine.h"
+#include "wkt.h"
+
+// Well-known text of cells written on demand. The cells are kept as the
+// meshes walked by `computeOutput()` with `CellOptions::deferText`, which
+// take several times less memory than their text, and the text of a cell is
+// written from its mesh only when it is asked for, exactly as it would have
+// been written at once.
+class LazyWkt
+{
+public:
+  // Take the walked meshes of `output`, whose faces are written as polygons
+  // if `polygons` is set, with `precision` decimals
+  LazyWkt( CellOutput&& output, bool polygons, int precision );
+
+  LazyWkt( const LazyWkt& ) = delete;
+  LazyWkt& operator=( const LazyWkt& ) = delete;
+
+  // Number of points
+  size_t size() const { return cells.computed.size(); }
+
+  // True if the cell of point `id` could be computed
+  bool computed( size_t id ) const { return cells.computed[id] != 0; }
+
+  // Replace `wkt` with the text of the cell of point `id`, which must have
+  // been computed. Not thread safe, since the writer is shared.
+  void write( size_t id, std::string& wkt );
+
+  // Replace `texts` with the text of the cells of the points `ids`, written on
+  // `threads` threads. The text of a cell that was not computed is empty.
+  void write( const std::vector< size_t >& ids,
+              int threads,
+              std::vector< std::string >& texts ) const;
+
+  // Approximate bytes held by the cells
+  size_t bytes() const;
+
+private:
+  CellOutput cells;
+  bool polygons;
+  NumberFormat format;
+  WktWriter writer;
+  CellMesh mesh;
+
+  // Load the mesh of the cell of point `id`
+  void load( size_t id, CellMesh& mesh ) const;
+};
+
+#endif
@@ -0,0 +1,169 @@
+#include <algorithm>
+#include <math.h>
+#include <stdexcept>
+#include "locate.h"
+
+static bool finite3( const double* position )
+{
+  return isfinite( position[0] ) && isfinite( position[1] ) && isfinite( position[2] );
+}
+
+PointLocator::PointLocator( const Points& points,
+                            const GridOptions& grid,
+                            const double* low,
+                            const double* high )
+{
+  if ( points.n < 1 )
+    throw std::invalid_argument( "Cannot locate queries without points." );
+
+  checkGrid( grid );
+
+  // Blocks sized for the points, over the bounding box of the points and the
+  // requested box
+  ContainerGrid pointGrid = containerGrid( points, 1, grid );
+  ContainerGrid span;
+  double length[3];
+  span.initMem = pointGrid.initMem;
+
+  for ( int a = 0; a < 3; a++ )
+  {
+    length[a] = ( pointGrid.high[a] - pointGrid.low[a] ) / pointGrid.blocks[a];
+    span.low[a] = low ? std::min( pointGrid.low[a], low[a] ) : pointGrid.low[a];
+    span.high[a] = high ? std::max( pointGrid.high[a], high[a] ) : pointGrid.high[a];
+  }
+
+  double blockCount = 1;
+  for ( int a = 0; a < 3; a++ )
+    blockCount *= floor( ( span.high[a] - span.low[a] ) / length[a] ) + 1;
+
+  double maxBlocks = std::max( 27.0, 8.0 * points.n );
+  double scale = blockCount > maxBlocks ? cbrt( blockCount / maxBlocks ) : 1;
+
+  // The upper bound is past the last point or query, which voro++ would
+  // otherwise leave out of the container
+  for ( int a = 0; a < 3; a++ )
+  {
+    double size = length[a] * scale;
+    span.blocks[a] = int( ( span.high[a] - span.low[a] ) / size ) + 1;
+    span.high[a] = span.low[a] + span.blocks[a] * size;
+  }
+
+  con = gridContainer( points, span );
+}
+
+bool PointLocator::covers( const Points& queries ) const
+{
+  for ( size_t q = 0; q < queries.n; q++ )
+  {
+    double position[3];
+    queries.at( q, position );
+    if ( finite3( position ) &&
+         !( position[0] >= con->ax && position[0] < con->bx &&
+            position[1] >= con->ay && position[1] < con->by &&
+            position[2] >= con->az && position[2] < con->bz ) )
+      return false;
+  }
+
+  return true;
+}
+
+void PointLocator::locate( const Points& queries,
+                           int threads,
+                           std::vector< int >& index,
+                           std::vector< double >& distance )
+{
+  if ( threads < 1 )
+    throw std::invalid_argument( "Invalid threads: Value must not be less than 1." );
+
+  index.assign( queries.n, -1 );
+  distance.assign( queries.n, NAN );
+
+  // Sort the queries by block, keeping the input order within each block
+  std::vector< int > block ( queries.n, -1 );
+  std::vector< size_t > start ( con->nxyz + 1, 0 ), order ( queries.n );
+  for ( size_t q = 0; q < queries.n; q++ )
+  {
+    double position[3];
+    queries.at( q, position );
+    if ( !finite3( position ) )
+      continue;
+
+    double i = floor( ( position[0] - con->ax ) * con->xsp );
+    double j = floor( ( position[1] - con->ay ) * con->ysp );
+    double k = floor( ( position[2] - con->az ) * con->zsp );
+    if ( i < 0 || i >= con->nx || j < 0 || j >= con->ny || k < 0 || k >= con->nz )
+      continue;
+
+    block[q] = int( i ) + con->nx * ( int( j ) + con->ny * int( k ) );
+    start[block[q] + 1]++;
+  }
+
+  for ( int ijk = 0; ijk < con->nxyz; ijk++ )
+    start[ijk + 1] += start[ijk];
+
+  std::vector< size_t > next ( start.begin(), start.end() - 1 );
+  for ( size_t q = 0; q < queries.n; q++ )
+  {
+    if ( block[q] >= 0 )
+      order[next[block[q]]++] = q;
+  }
+
+  // Locate the queries of each block
+  std::vector< std::unique_ptr< voro::voro_compute< voro::container > > > computes;
+  for ( int t = 0; t < threads; t++ )
+  {
+    computes.emplace_back(
+      new voro::voro_compute< voro::container >( *con, con->nx, con->ny, con->nz ) );
+  }
+
+  parallelFor( con->nxyz, threads, [&]( int ijk, int thread )
+  {
+    int k = ijk / con->nxy;
+    int j = ( ijk - k * con->nxy ) / con->nx;
+    int i = ijk - con->nx * ( j + con->ny * k );
+
+    for ( size_t s = start[ijk]; s < start[ijk + 1]; s++ )
+    {
+      size_t q = order[s];
+      double position[3], squared;
+      voro::particle_record record;
+      queries.at( q, position );
+
+      computes[thread]->find_voronoi_cell( position[0], position[1], position[2],
+                                           i, j, k, ijk, record, squared );
+      if ( record.ijk >= 0 )
+      {
+        index[q] = con->id[record.ijk][record.l];
+        distance[q] = sqrt( squared );
+      }
+    }
+  } );
+}
+
+void locatePoints( const Points& points,
+                   const Points& queries,
+                   const GridOptions& grid,
+                   int threads,
+                   std::vector< int >& index,
+                   std::vector< double >& distance )
+{
+  // Bounding box of the finite queries
+  double low[3] = { INFINITY, INFINITY, INFINITY };
+  double high[3] = { -INFINITY, -INFINITY, -INFINITY };
+  for ( size_t q = 0; q < queries.n; q++ )
+  {
+    double position[3];
+    queries.at( q, position );
+    if ( !finite3( position ) )
+      continue;
+
+    for ( int a = 0; a < 3; a++ )
+    {
+      low[a] = std::min( low[a], position[a] );
+      high[a] = std::max( high[a], position[a] );
+    }
+  }
+
+  PointLocator locator ( points, grid, low, high );
+  locator.locate( queries, threads, index, distance );
+}
@@ -0,0 +1,53 @@
+#ifndef LOCATE_H
+#define LOCATE_H
+
+#include <memory>
+#include <vector>
+#include <voro++.hh>
+
+#include "engine.h"
+
+// Container of points in which queries are located by the voronoi cell that
+// holds them, which is the cell of their nearest point. The container spans
+// the points and, if given, the box from `low` to `high`, with the blocks of
+// `grid`. The blocks are made larger if the box reaches so far that there
+// would be many more blocks than points.
+class PointLocator
+{
+public:
+  PointLocator( const Points& points,
+                const GridOptions& grid,
+                const double* low = nullptr,
+                const double* high = nullptr );
+
+  // True if the container holds all the finite `queries`
+  bool covers( const Points& queries ) const;
+
+  // For each of the `queries`, the index of the point whose cell holds it and
+  // the distance to that point. Queries that cannot be located, such as
+  // non-finite ones or those outside of the container, get the index -1 and
+  // a NaN distance.
+  //
+  // The queries are sorted by block, and the blocks are distributed among the
+  // `threads`, each searching with its own voro++ search object, so that
+  // nearby queries are located one after the other.
+  void locate( const Points& queries,
+               int threads,
+               std::vector< int >& index,
+               std::vector< double >& distance );
+
+private:
+  std::unique_ptr< voro::container > con;
+};
+
+// Locate the `queries` in the cells of `points` as above, in a container that
+// also spans the queries, so queries outside of the bounding box of the points
+// are located as well
+void locatePoints( const Points& points,
+                   const Points& queries,
+                   const GridOptions& grid,
+                   int threads,
+                   std::vector< int >& index,
+                   std::vector< double >& distance );
+
+#endif
@@ -0,0 +1,83 @@
+#include <stdexcept>
+#include "mappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+MappedFile::MappedFile( const std::string& path )
+{
+  HANDLE file = CreateFileA( path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL,
+                             OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL );
+  if ( file == INVALID_HANDLE_VALUE )
+    throw std::invalid_argument( "Invalid file: Cannot open " + path + "." );
+
+  LARGE_INTEGER size;
+  if ( !GetFileSizeEx( file, &size ) || size.QuadPart == 0 )
+  {
+    CloseHandle( file );
+    throw std::invalid_argument( "Invalid file: " + path + " is empty." );
+  }
+
+  length = size_t( size.QuadPart );
+  mapping = CreateFileMappingA( file, NULL, PAGE_READONLY, 0, 0, NULL );
+  CloseHandle( file );
+  if ( !mapping )
+    throw std::invalid_argument( "Invalid file: Cannot map " + path + "." );
+
+  address = MapViewOfFile( mapping, FILE_MAP_READ, 0, 0, 0 );
+  if ( !address )
+  {
+    CloseHandle( mapping );
+    throw std::invalid_argument( "Invalid file: Cannot map " + path + "." );
+  }
+}
+
+MappedFile::~MappedFile()
+{
+  UnmapViewOfFile( address );
+  CloseHandle( mapping );
+}
+
+#else
+
+MappedFile::MappedFile( const std::string& path )
+{
+  int file = open( path.c_str(), O_RDONLY );
+  if ( file < 0 )
+    throw std::invalid_argument( "Invalid file: Cannot open " + path + "." );
+
+  struct stat status;
+  if ( fstat( file, &status ) != 0 || status.st_size == 0 )
+  {
+    close( file );
+    throw std::invalid_argument( "Invalid file: " + path + " is empty." );
+  }
+
+  // The mapping holds its own reference to the file
+  length = size_t( status.st_size );
+  address = mmap( nullptr, length, PROT_READ, MAP_SHARED, file, 0 );
+  close( file );
+  if ( address == MAP_FAILED )
+  {
+    address = nullptr;
+    throw std::invalid_argument( "Invalid file: Cannot map " + path + "." );
+  }
+
+  // Mapped files are mostly scanned from start to end
+  madvise( address, length, MADV_SEQUENTIAL );
+}
+
+MappedFile::~MappedFile()
+{
+  munmap( address, length );
+}
+
+#endif
@@ -0,0 +1,33 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory map of a whole file. The operating system loads the pages
+// as they are read and can drop them again when memory is short, so a file
+// larger than memory can be scanned as an array.
+class MappedFile
+{
+public:
+  // Map the file at `path`. Throws std::invalid_argument if it cannot be
+  // opened or mapped, or is empty.
+  explicit MappedFile( const std::string& path );
+  ~MappedFile();
+
+  MappedFile( const MappedFile& ) = delete;
+  MappedFile& operator=( const MappedFile& ) = delete;
+
+  const void* data() const { return address; }
+  size_t size() const { return length; }
+
+private:
+  void* address = nullptr;
+  size_t length = 0;
+
+#ifdef _WIN32
+  void* mapping = nullptr;
+#endif
+};
+
+#endif
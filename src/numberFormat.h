@@ -0,0 +1,41 @@
+#ifndef NUMBERFORMAT_H
+#define NUMBERFORMAT_H
+
+#include <charconv>
+#include <string>
+
+// Writes numbers as text with std::to_chars, without allocating and
+// independently of the locale. With a negative precision, numbers are written
+// in the shortest form that reads back to the same double. Otherwise they are
+// written in fixed notation with `precision` decimals, which for a precision
+// of 6 is the same text as std::to_string().
+class NumberFormat
+{
+public:
+
+  explicit NumberFormat( int precision = 6 ) : precision( precision ) {}
+
+  // Append `value` to `out`
+  void append( std::string& out, double value ) const
+  {
+    // Enough for the longest fixed notation of a double (309 digits) with
+    // the largest precision accepted by the exported functions
+    char buffer[352];
+    std::to_chars_result result;
+
+    if ( precision < 0 )
+      result = std::to_chars( buffer, buffer + sizeof( buffer ), value );
+    else
+      result = std::to_chars( buffer, buffer + sizeof( buffer ), value,
+                              std::chars_format::fixed, precision );
+
+    out.append( buffer, result.ptr );
+  }
+
+private:
+
+  int precision;
+
+};
+
+#endif
@@ -0,0 +1,72 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Run `work( item, thread )` for every item in [0, count) using `threads`
+// workers. Items are handed out in small chunks from a shared counter so that
+// unevenly loaded container blocks do not leave workers idle. `thread` is the
+// index of the worker (0 to threads - 1) and can be used to address per-thread
+// scratch space. A positive `chunk` sets the number of items handed out at
+// once, e.g. 1 so that items finish roughly in order. The first exception
+// thrown by a worker is rethrown in the calling thread after all workers have
+// stopped.
+template < class Work >
+void parallelFor( int count, int threads, Work work, int chunk = 0 )
+{
+  if ( threads < 2 || count < 2 )
+  {
+    for ( int item = 0; item < count; item++ )
+      work( item, 0 );
+    return;
+  }
+
+  threads = std::min( threads, count );
+
+  if ( chunk < 1 )
+    chunk = std::max( 1, count / ( threads * 64 ) );
+
+  std::atomic< int > next ( 0 );
+  std::atomic< bool > failed ( false );
+  std::exception_ptr error;
+  std::mutex errorMutex;
+  std::vector< std::thread > pool;
+
+  auto run = [&]( int thread )
+  {
+    try
+    {
+      int start;
+      while ( !failed && ( start = next.fetch_add( chunk ) ) < count )
+      {
+        int end = std::min( start + chunk, count );
+        for ( int item = start; item < end; item++ )
+          work( item, thread );
+      }
+    }
+    catch ( ... )
+    {
+      std::lock_guard< std::mutex > lock ( errorMutex );
+      if ( !error )
+        error = std::current_exception();
+      failed = true;
+    }
+  };
+
+  for ( int thread = 1; thread < threads; thread++ )
+    pool.emplace_back( run, thread );
+  run( 0 );
+
+  for ( std::thread& worker : pool )
+    worker.join();
+
+  if ( error )
+    std::rethrow_exception( error );
+}
+
+#endif
@@ -0,0 +1,48 @@
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <chrono>
+#include <stddef.h>
+
+// Work done by one thread during a profiled run. Times are in seconds of
+// thread time, so they add up to more than the elapsed time on several
+// threads.
+struct ThreadProfile
+{
+  double compute = 0, walk = 0, write = 0;
+  double cells = 0, failed = 0;
+};
+
+// Measures the time between successive laps. `Stopwatch< false >` does
+// nothing and is optimized away, so code instrumented with it costs nothing
+// unless profiling is requested at compile time.
+template < bool Enabled >
+class Stopwatch
+{
+public:
+  void start() {}
+  void lap( double& ) {}
+};
+
+template <>
+class Stopwatch< true >
+{
+public:
+
+  void start() { last = std::chrono::steady_clock::now(); }
+
+  // Add the time since the last lap (or start) to `total`
+  void lap( double& total )
+  {
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    total += std::chrono::duration< double >( now - last ).count();
+    last = now;
+  }
+
+private:
+
+  std::chrono::steady_clock::time_point last;
+
+};
+
+#endif
@@ -0,0 +1,391 @@
+#include <algorithm>
+#include <climits>
+#include <math.h>
+#include <stdexcept>
+#include "mappedFile.h"
+#include "tiles.h"
+
+void checkTileOptions( const TileOptions& tiles )
+{
+  double count = 1;
+  for ( int a = 0; a < 3; a++ )
+  {
+    if ( tiles.tiles[a] < 1 )
+      throw std::invalid_argument( "Invalid tiles: Value must be three positive integers." );
+    count *= tiles.tiles[a];
+  }
+
+  if ( count > INT_MAX )
+    throw std::invalid_argument( "Invalid tiles: There are too many tiles." );
+
+  if ( !( tiles.halo >= 0 ) || !isfinite( tiles.halo ) )
+    throw std::invalid_argument( "Invalid halo: Value must be finite and not negative." );
+}
+
+static bool finite3( const double* position )
+{
+  return isfinite( position[0] ) && isfinite( position[1] ) && isfinite( position[2] );
+}
+
+// True if no point outside the box from `low` to `high` can be closer to a
+// vertex of the cell `vc` than its particle at `p`. `inner` flags the sides of
+// the box beyond which there are points, low x first and high z last.
+static bool secureCell( voro::voronoicell& vc,
+                        const double* p,
+                        const double* low,
+                        const double* high,
+                        const bool* inner,
+                        std::vector< double >& vertices )
+{
+  vc.vertices( p[0], p[1], p[2], vertices );
+
+  for ( size_t v = 0; v < vertices.size(); v += 3 )
+  {
+    const double* vertex = vertices.data() + v;
+    double r = sqrt( ( vertex[0] - p[0] ) * ( vertex[0] - p[0] )
+                     + ( vertex[1] - p[1] ) * ( vertex[1] - p[1] )
+                     + ( vertex[2] - p[2] ) * ( vertex[2] - p[2] ) );
+
+    for ( int a = 0; a < 3; a++ )
+    {
+      if ( ( inner[a] && vertex[a] - r < low[a] ) ||
+           ( inner[3 + a] && vertex[a] + r > high[a] ) )
+        return false;
+    }
+  }
+
+  return true;
+}
+
+void computeTiles( const double* xyz,
+                   size_t n,
+                   const TileOptions& tiles,
+                   const CellOptions& options,
+                   const CellStream& stream,
+                   std::vector< TileReport >& reports )
+{
+  CellOptions tileOptions = options;
+  tileOptions.output = OUTPUT_WKT;
+  checkOptions( Points { nullptr, nullptr, nullptr, n }, tileOptions );
+  checkTileOptions( tiles );
+
+  if ( !options.anisotropy.empty() )
+    throw std::invalid_argument( "Invalid anisotropy: Tiled runs do not support an anisotropy." );
+
+  if ( stream.format == STREAM_WKT )
+    throw std::invalid_argument(
+      "Invalid format: Tiled runs write the point ids, so value must be \"geojson\" or \"csv\"." );
+
+  // Bounding box of the points, and the container of all points
+  double min[3] = { INFINITY, INFINITY, INFINITY };
+  double max[3] = { -INFINITY, -INFINITY, -INFINITY };
+  size_t finite = 0;
+  for ( size_t i = 0; i < n; i++ )
+  {
+    const double* position = xyz + 3 * i;
+    if ( !finite3( position ) )
+      continue;
+
+    finite++;
+    for ( int a = 0; a < 3; a++ )
+    {
+      min[a] = std::min( min[a], position[a] );
+      max[a] = std::max( max[a], position[a] );
+    }
+  }
+
+  if ( finite < 2 )
+    throw std::invalid_argument( "Cannot generate cells if points are less than 2." );
+
+  double low[3], high[3], size[3], volume = 1;
+  containerBounds( min, max, options.containerRatio, low, high );
+  for ( int a = 0; a < 3; a++ )
+  {
+    size[a] = ( max[a] - min[a] ) / tiles.tiles[a];
+    volume *= setThreshold( max[a] - min[a] );
+  }
+
+  // Index along `a` of the tiles that hold `value`, which never decreases as
+  // the value grows, so that a box overlaps the tiles between the indices of
+  // its bounds
+  auto axisTile = [&]( int a, double value )
+  {
+    double step = size[a] > 0 ? ( value - min[a] ) / size[a] : 0;
+    if ( step <= 0 )
+      return 0;
+    return step >= tiles.tiles[a] - 1 ? tiles.tiles[a] - 1 : int( step );
+  };
+
+  // Tile of the point at `position`
+  auto tileOf = [&]( const double* position )
+  {
+    return axisTile( 0, position[0] )
+      + tiles.tiles[0] * ( axisTile( 1, position[1] )
+                           + tiles.tiles[1] * axisTile( 2, position[2] ) );
+  };
+
+  // Points of each tile, in the order of the points: those of tile `t` are
+  // from tilePoints[tileStart[t]] up to tilePoints[tileStart[t + 1]]
+  int tileCount = tiles.tiles[0] * tiles.tiles[1] * tiles.tiles[2];
+  std::vector< size_t > tileStart ( tileCount + 1, 0 ), tilePoints ( finite );
+  for ( size_t i = 0; i < n; i++ )
+  {
+    if ( finite3( xyz + 3 * i ) )
+      tileStart[tileOf( xyz + 3 * i ) + 1]++;
+  }
+  for ( int t = 0; t < tileCount; t++ )
+    tileStart[t + 1] += tileStart[t];
+
+  std::vector< size_t > fill ( tileStart.begin(), tileStart.end() - 1 );
+  for ( size_t i = 0; i < n; i++ )
+  {
+    if ( finite3( xyz + 3 * i ) )
+      tilePoints[fill[tileOf( xyz + 3 * i )]++] = i;
+  }
+
+  int threads = options.threads;
+  CellWorkers workers = cellWorkers( threads );
+  std::vector< std::vector< double > > vertices ( threads );
+  std::vector< std::vector< size_t > > failed ( threads );
+  std::vector< RecordWriter > records ( threads, RecordWriter( stream.format,
+                                                               NumberFormat( options.precision ),
+                                                               options.polygons ) );
+
+  std::vector< std::unique_ptr< DemClipper > > clippers;
+  for ( int t = 0; t < threads && !options.dem.empty(); t++ )
+    clippers.emplace_back( new DemClipper( options.dem ) );
+
+  std::unique_ptr< InfluenceWall > influence;
+  if ( !options.influence.empty() )
+    influence.reset( new InfluenceWall( options.influence ) );
+
+  ContainerWalls containerWalls ( options.walls );
+  ReorderBuffer buffer ( stream.file, 0 );
+  size_t chunk = 0;
+  std::string header = records[0].header();
+  buffer.write( chunk++, header );
+
+  reports.clear();
+  for ( int t = 0; t < tileCount; t++ )
+  {
+    TileReport report;
+    report.tile = t;
+
+    int index[3] = { t % tiles.tiles[0],
+                     ( t / tiles.tiles[0] ) % tiles.tiles[1],
+                     t / ( tiles.tiles[0] * tiles.tiles[1] ) };
+    double tileLow[3], tileHigh[3];
+    for ( int a = 0; a < 3; a++ )
+    {
+      tileLow[a] = min[a] + index[a] * size[a];
+      tileHigh[a] = index[a] == tiles.tiles[a] - 1 ? max[a] : tileLow[a] + size[a];
+    }
+
+    // Points of the tile, in the order of the points
+    std::vector< size_t > owned ( tilePoints.begin() + tileStart[t],
+                                  tilePoints.begin() + tileStart[t + 1] );
+
+    report.points = owned.size();
+    std::vector< std::string > texts ( owned.size() );
+    std::vector< char > computed ( owned.size(), 0 );
+    std::vector< size_t > pending ( owned.size() );
+    for ( size_t o = 0; o < owned.size(); o++ )
+      pending[o] = o;
+
+    double halo = tiles.halo > 0 ? tiles.halo : 2 * cbrt( volume / finite );
+    while ( !pending.empty() )
+    {
+      report.rounds++;
+      report.halo = halo;
+
+      // Box of the points gathered around the tile, and whether there are
+      // points beyond each of its sides
+      double boxLow[3], boxHigh[3];
+      bool inner[6];
+      for ( int a = 0; a < 3; a++ )
+      {
+        boxLow[a] = tileLow[a] - halo;
+        boxHigh[a] = tileHigh[a] + halo;
+        inner[a] = boxLow[a] > min[a];
+        inner[3 + a] = boxHigh[a] < max[a];
+      }
+
+      // Points of the box, from the tiles it overlaps, in the order of the
+      // points
+      int first[3], last[3];
+      for ( int a = 0; a < 3; a++ )
+      {
+        first[a] = axisTile( a, boxLow[a] );
+        last[a] = axisTile( a, boxHigh[a] );
+      }
+
+      std::vector< size_t > inBox;
+      for ( int k = first[2]; k <= last[2]; k++ )
+      {
+        for ( int j = first[1]; j <= last[1]; j++ )
+        {
+          for ( int i = first[0]; i <= last[0]; i++ )
+          {
+            int u = i + tiles.tiles[0] * ( j + tiles.tiles[1] * k );
+            for ( size_t b = tileStart[u]; b < tileStart[u + 1]; b++ )
+            {
+              const double* position = xyz + 3 * tilePoints[b];
+              if ( position[0] >= boxLow[0] && position[0] <= boxHigh[0] &&
+                   position[1] >= boxLow[1] && position[1] <= boxHigh[1] &&
+                   position[2] >= boxLow[2] && position[2] <= boxHigh[2] )
+                inBox.push_back( tilePoints[b] );
+            }
+          }
+        }
+      }
+      std::sort( inBox.begin(), inBox.end() );
+
+      // Coordinates of the points of the box, with the local index of each
+      // point of the tile
+      std::vector< double > x, y, z;
+      std::vector< size_t > localOf ( owned.size() );
+      size_t next = 0;
+      for ( size_t i : inBox )
+      {
+        const double* position = xyz + 3 * i;
+        if ( next < owned.size() && owned[next] == i )
+          localOf[next++] = x.size();
+        x.push_back( position[0] );
+        y.push_back( position[1] );
+        z.push_back( position[2] );
+      }
+      report.gathered = x.size();
+
+      // Container of the box, or of all points where the box reaches past
+      // them. Inner sides are moved out slightly, since voro++ leaves out
+      // points on the upper bounds.
+      Points local { x.data(), y.data(), z.data(), x.size() };
+      ContainerGrid grid = containerGrid( local, 1, options.grid );
+      for ( int a = 0; a < 3; a++ )
+      {
+        double length = ( grid.high[a] - grid.low[a] ) / grid.blocks[a];
+        double containerLow = inner[a] ? boxLow[a] : low[a];
+        double containerHigh = inner[3 + a]
+          ? boxHigh[a] + 1e-9 * ( boxHigh[a] - boxLow[a] )
+          : high[a];
+        grid.low[a] = containerLow;
+        grid.high[a] = containerHigh;
+        grid.blocks[a] = std::max( 1, int( ceil( ( containerHigh - containerLow ) / length ) ) );
+      }
+      grid.counts.clear();
+
+      // Margins of a large container ratio would add many empty blocks
+      double blockCount = double( grid.blocks[0] ) * grid.blocks[1] * grid.blocks[2];
+      double maxBlocks = std::max( 27.0, 8.0 * x.size() );
+      if ( blockCount > maxBlocks )
+      {
+        double scale = cbrt( maxBlocks / blockCount );
+        for ( int a = 0; a < 3; a++ )
+          grid.blocks[a] = std::max( 1, int( grid.blocks[a] * scale ) );
+      }
+
+      std::unique_ptr< voro::container > con = gridContainer( local, grid );
+      containerWalls.addTo( *con );
+      if ( influence )
+        con->add_wall( *influence );
+
+      std::vector< std::pair< int, int > > located ( x.size(), std::make_pair( -1, 0 ) );
+      for ( int ijk = 0; ijk < con->nxyz; ijk++ )
+      {
+        for ( int q = 0; q < con->co[ijk]; q++ )
+          located[con->id[ijk][q]] = std::make_pair( ijk, q );
+      }
+
+      std::vector< std::unique_ptr< voro::voro_compute< voro::container > > > computes;
+      for ( int thread = 0; thread < threads; thread++ )
+      {
+        computes.emplace_back(
+          new voro::voro_compute< voro::container >( *con, con->nx, con->ny, con->nz ) );
+      }
+
+      parallelFor( int( pending.size() ), threads, [&]( int item, int thread )
+      {
+        size_t o = pending[item];
+        size_t id = owned[o];
+        CellWorker& worker = *workers[thread];
+        std::pair< int, int > cell = located[localOf[o]];
+        const double* p = xyz + 3 * id;
+        double cellVolume = NAN;
+        bool stored = false;
+
+        if ( cell.first >= 0 )
+        {
+          int ijk = cell.first;
+          int k = ijk / con->nxy;
+          int j = ( ijk - k * con->nxy ) / con->nx;
+          int i = ijk - con->nx * ( j + con->ny * k );
+
+          if ( computes[thread]->compute_cell( worker.vc, ijk, cell.second, i, j, k ) &&
+               ( !influence || influence->clip( worker.vc ) ) )
+          {
+            if ( !secureCell( worker.vc, p, boxLow, boxHigh, inner, vertices[thread] ) )
+            {
+              failed[thread].push_back( o );
+              return;
+            }
+
+            TerrainSide side = BELOW_TERRAIN;
+            if ( !clippers.empty() )
+              side = clippers[thread]->side( worker.vc, p[0], p[1], p[2] );
+
+            if ( side == CROSSES_TERRAIN )
+            {
+              cellVolume = clippers[thread]->clip( worker.vc, p[0], p[1], p[2], &worker.mesh );
+              stored = worker.mesh.faces() > 0;
+            }
+
+            else if ( side == BELOW_TERRAIN )
+            {
+              walkCell( worker.vc, p[0], p[1], p[2], worker.mesh );
+              cellVolume = worker.vc.volume();
+              stored = true;
+            }
+          }
+        }
+
+        computed[o] = stored;
+        records[thread].append( id, stored ? &worker.mesh : nullptr, cellVolume, texts[o] );
+      } );
+
+      pending.clear();
+      for ( std::vector< size_t >& cells : failed )
+      {
+        pending.insert( pending.end(), cells.begin(), cells.end() );
+        cells.clear();
+      }
+      std::sort( pending.begin(), pending.end() );
+      report.recomputed += pending.size();
+      halo *= 2;
+    }
+
+    for ( size_t o = 0; o < owned.size(); o++ )
+    {
+      report.computed += computed[o];
+      buffer.write( chunk++, texts[o] );
+    }
+
+    reports.push_back( report );
+  }
+
+  buffer.finish( chunk );
+}
+
+void computeTiles( const std::string& path,
+                   const TileOptions& tiles,
+                   const CellOptions& options,
+                   const CellStream& stream,
+                   std::vector< TileReport >& reports )
+{
+  MappedFile file ( path );
+  if ( file.size() % ( 3 * sizeof( double ) ) != 0 )
+    throw std::invalid_argument( "Invalid file: " + path + " does not hold x, y, z triples of doubles." );
+
+  computeTiles( static_cast< const double* >( file.data() ),
+                file.size() / ( 3 * sizeof( double ) ),
+                tiles, options, stream, reports );
+}
@@ -0,0 +1,77 @@
+#ifndef TILES_H
+#define TILES_H
+
+#include <string>
+#include <vector>
+
+#include "engine.h"
+
+// Division of the bounding box of the points into tiles whose cells are
+// computed one after the other by `computeTiles()`
+struct TileOptions
+{
+  // Number of tiles along x, y and z
+  int tiles[3] = { 1, 1, 1 };
+
+  // Width of the halo of points gathered around each tile at first, or 0 for
+  // twice the mean spacing of the points
+  double halo = 0;
+};
+
+// Check `tiles`
+void checkTileOptions( const TileOptions& tiles );
+
+// Summary of the computation of one tile
+struct TileReport
+{
+  // Index of the tile, x first, then y, then z
+  int tile = 0;
+
+  // Points in the tile, and points gathered with its halo in the last round
+  size_t points = 0, gathered = 0;
+
+  // Width of the halo in the last round
+  double halo = 0;
+
+  // Number of rounds, and of cells computed again with a wider halo
+  int rounds = 0;
+  size_t recomputed = 0;
+
+  // Number of cells that could be computed
+  size_t computed = 0;
+};
+
+// Compute the cells of the `n` points stored as x, y, z triples at `xyz`, e.g.
+// a memory-mapped file, one tile at a time, and write them to `stream` tile by
+// tile, in the order of the points within a tile. The ids of the points are
+// sorted by tile once, and only the points of one tile and of a halo around
+// it, gathered from the tiles the halo overlaps, are held at once. The cells
+// of the points of a tile are computed in a container of these points and
+// checked: a cell is exact if no point outside the gathered box can be closer
+// to any of its vertices than the point of the cell, i.e. if the sphere around
+// each vertex through the point stays within the box wherever there are points
+// beyond it. Cells that fail the check are computed again with twice the halo
+// until they pass, which they do at the latest once the halo reaches past all
+// points. The container is the one `computeOutput()` would use where the box
+// reaches the bounding box of the points. The cells are then the same as those
+// of `computeOutput()`, up to rounding and the order of their faces. Points
+// with missing coordinates have no record. `stream` must be GeoJSON or CSV,
+// whose records hold the point ids. Anisotropy is not supported and
+// `options.output` is ignored.
+void computeTiles( const double* xyz,
+                   size_t n,
+                   const TileOptions& tiles,
+                   const CellOptions& options,
+                   const CellStream& stream,
+                   std::vector< TileReport >& reports );
+
+// Compute the cells of the points of the file at `path` as `computeTiles()`
+// does. The file holds x, y, z triples of doubles in the byte order of the
+// machine and is read through a memory map, so it can be larger than memory.
+void computeTiles( const std::string& path,
+                   const TileOptions& tiles,
+                   const CellOptions& options,
+                   const CellStream& stream,
+                   std::vector< TileReport >& reports );
+
+#endif
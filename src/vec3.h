@@ -0,0 +1,87 @@
+#ifndef VEC3_H
+#define VEC3_H
+
+// Small geometry kernel for the cell walk. Everything is inline and free of
+// branches and transcendental functions, so it can be used in the innermost
+// loops.
+struct Vec3
+{
+  double x, y, z;
+
+  constexpr Vec3() : x( 0 ), y( 0 ), z( 0 ) {}
+  constexpr Vec3( double x, double y, double z ) : x( x ), y( y ), z( z ) {}
+
+  // Vector at `v[0]`, `v[1]`, `v[2]`, e.g. a vertex stored by voro++ at every
+  // 3 elements
+  static constexpr Vec3 at( const double* v ) { return Vec3( v[0], v[1], v[2] ); }
+};
+
+constexpr Vec3 operator+( const Vec3& a, const Vec3& b )
+{
+  return Vec3( a.x + b.x, a.y + b.y, a.z + b.z );
+}
+
+constexpr Vec3 operator-( const Vec3& a, const Vec3& b )
+{
+  return Vec3( a.x - b.x, a.y - b.y, a.z - b.z );
+}
+
+constexpr Vec3 operator*( double s, const Vec3& a )
+{
+  return Vec3( s * a.x, s * a.y, s * a.z );
+}
+
+// Dot product of two vectors
+constexpr double dot( const Vec3& a, const Vec3& b )
+{
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+// Cross product of two vectors
+constexpr Vec3 cross( const Vec3& a, const Vec3& b )
+{
+  return Vec3( a.y * b.z - b.y * a.z,
+               a.z * b.x - b.z * a.x,
+               a.x * b.y - b.x * a.y );
+}
+
+// Triple product (b - a) x (c - a) . (o - a). It is positive if `o` lies on
+// the side of the plane through the triangle abc that its normal points to,
+// negative on the other side and zero on the plane.
+constexpr double orientation( const Vec3& a, const Vec3& b, const Vec3& c,
+                              const Vec3& o )
+{
+  return dot( cross( b - a, c - a ), o - a );
+}
+
+// True if the normal of the triangle abc points away from `o`, i.e. the
+// triangle is wound counter-clockwise when seen from outside a cell that
+// contains `o`.
+constexpr bool facesAway( const Vec3& a, const Vec3& b, const Vec3& c,
+                          const Vec3& o )
+{
+  return orientation( a, b, c, o ) < 0;
+}
+
+// Batch variant of `orientation()` for `n` triangles stored as separate
+// coordinate arrays (structure of arrays), all tested against `o`. Written
+// without branches so that the compiler can vectorize the loop.
+inline void orientations( int n,
+                          const double* ax, const double* ay, const double* az,
+                          const double* bx, const double* by, const double* bz,
+                          const double* cx, const double* cy, const double* cz,
+                          const Vec3& o,
+                          double* out )
+{
+  for ( int t = 0; t < n; t++ )
+  {
+    double ux = bx[t] - ax[t], uy = by[t] - ay[t], uz = bz[t] - az[t];
+    double vx = cx[t] - ax[t], vy = cy[t] - ay[t], vz = cz[t] - az[t];
+    double wx = o.x - ax[t], wy = o.y - ay[t], wz = o.z - az[t];
+    out[t] = ( uy * vz - vy * uz ) * wx
+           + ( uz * vx - vz * ux ) * wy
+           + ( ux * vy - vx * uy ) * wz;
+  }
+}
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef VORO3D_H
+#define VORO3D_H
+
+/* C interface to the voro3d engine, for use outside of R. All functions are
+ * safe to call from any thread; a result must not be freed while another
+ * thread reads it. Functions returning int return VORO3D_OK on success and an
+ * error code otherwise, with a description in voro3d_last_error(). */
+
+#include <stddef.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Status codes */
+#define VORO3D_OK 0
+#define VORO3D_INVALID_ARGUMENT 1
+#define VORO3D_FAILURE 2
+
+/* Output formats */
+#define VORO3D_WKT 0
+#define VORO3D_WKB 1
+#define VORO3D_MESH 2
+#define VORO3D_VOLUME 3
+#define VORO3D_ADJACENCY 4
+#define VORO3D_BLOCKS 5
+
+/* Formats of the files written by voro3d_stream() */
+#define VORO3D_STREAM_WKT 0
+#define VORO3D_STREAM_GEOJSON 1
+#define VORO3D_STREAM_CSV 2
+
+/* Container grids, see containerGrid() in grid.h */
+#define VORO3D_GRID_UNIFORM 0
+#define VORO3D_GRID_TUNED 1
+#define VORO3D_GRID_ANISOTROPIC 2
+
+typedef struct voro3d_options
+{
+  /* Ratio between the length of the container and the length of the bounding
+   * box of the points, at least 1 */
+  double container_ratio;
+  /* Number of threads used to compute the cells */
+  int threads;
+  /* One of the output formats */
+  int output;
+  /* Non-zero to write each face as one polygon instead of a fan of
+   * triangles */
+  int polygons;
+  /* Number of decimals of coordinates in well-known text, negative for the
+   * shortest text that reads back to the same number */
+  int precision;
+  /* NULL, or the radius of each point, for the cells of the power
+   * (Laguerre) diagram */
+  const double* radius;
+  /* One of the container grids */
+  int grid;
+  /* Number of blocks along x, y and z, or zeros to let `grid` choose */
+  int blocks[3];
+  /* Initial number of particles per block, or 0 to let `grid` choose */
+  int init_mem;
+  /* `plane_count` half-spaces a x + b y + c z <= d stored as a, b, c, d */
+  const double* planes;
+  size_t plane_count;
+  /* Convex prism with the `prism_vertices` vertices (prism_x, prism_y)
+   * between the elevations prism_z[0] and prism_z[1], unless prism_vertices
+   * is 0 */
+  const double* prism_x;
+  const double* prism_y;
+  size_t prism_vertices;
+  double prism_z[2];
+  /* `cylinder_count` cylinders stored as a point on the axis, the direction
+   * of the axis and the radius (7 numbers each) */
+  const double* cylinders;
+  size_t cylinder_count;
+  /* Ranges along the major, semi-major and minor axes of the ellipsoid
+   * around each point beyond which its cell is clipped, or zeros for none,
+   * and its strike, dip and plunge in degrees */
+  double max_radius[3];
+  double max_radius_angles[3];
+  /* Ranges of continuity along the major, semi-major and minor axes, or
+   * zeros for none, and their strike, dip and plunge in degrees. The cells
+   * are computed where the ellipsoid of these ranges is a sphere and mapped
+   * back. */
+  double anisotropy[3];
+  double anisotropy_angles[3];
+  /* Terrain clipping the cells, unless dem_z is NULL: the elevations of the
+   * `dem_nx` by `dem_ny` grid nodes (dem_x0 + i dem_dx, dem_y0 + j dem_dy)
+   * stored at dem_z[i + dem_nx j]. Cells keep their part below the terrain;
+   * cells entirely above it are not computed. */
+  const double* dem_z;
+  int dem_nx;
+  int dem_ny;
+  double dem_x0;
+  double dem_y0;
+  double dem_dx;
+  double dem_dy;
+  /* Regular block model by which the cells are split for VORO3D_BLOCKS: the
+   * lower corner of its first block, the size of the blocks and their number
+   * along x, y and z. Block (i, j, k) has the index
+   * i + block_count[0] (j + block_count[1] k). */
+  double block_origin[3];
+  double block_size[3];
+  int block_count[3];
+} voro3d_options;
+
+/* Cells computed by voro3d_compute() */
+typedef struct voro3d_result voro3d_result;
+
+/* Fill `options` with the defaults: a container ratio of 1, one thread,
+ * well-known text of triangle fans with 6 decimals, the uniform grid, no
+ * walls, no largest radius, no anisotropy and no terrain */
+void voro3d_default_options( voro3d_options* options );
+
+/* Compute the cells of the `n` points with coordinates `x`, `y` and `z`. On
+ * success, `*result` must be released with voro3d_free(). */
+int voro3d_compute( const double* x, const double* y, const double* z,
+                    size_t n,
+                    const voro3d_options* options,
+                    voro3d_result** result );
+
+/* Like voro3d_compute(), but the cells of each group of points are computed
+ * in a container of their own, as if voro3d_compute() was called on the
+ * points of each group. `group` holds the group code of each point; points
+ * with a negative code and groups of a single point get no cells. */
+int voro3d_compute_grouped( const double* x, const double* y, const double* z,
+                            const int* group,
+                            size_t n,
+                            const voro3d_options* options,
+                            voro3d_result** result );
+
+/* Compute the cells of the `n` points like voro3d_compute(), but write each
+ * cell to `file` in the stream format `format` as soon as it is computed,
+ * one record per point in the order of the points, instead of keeping the
+ * cells. VORO3D_STREAM_WKT writes one cell per line, or POLYHEDRALSURFACE
+ * EMPTY; VORO3D_STREAM_GEOJSON writes a GeoJSON text sequence of Features
+ * whose id is the 1-based point number, whose geometry is a MultiPolygon of
+ * the faces, or null, and whose volume is a property; VORO3D_STREAM_CSV
+ * writes the lines id,wkt,volume after a header, with NA for missing cells.
+ * The output of `options` is ignored. Unless `computed` is NULL, it receives
+ * the number of cells computed. The file is flushed but not closed. */
+int voro3d_stream( const double* x, const double* y, const double* z,
+                   size_t n,
+                   const voro3d_options* options,
+                   int format,
+                   FILE* file,
+                   size_t* computed );
+
+/* Compute the cells of the points of the file at `path`, which holds x, y, z
+ * triples of doubles in the byte order of the machine, one tile at a time,
+ * and write them to `file` like voro3d_stream(). The bounding box of the
+ * points is split into `tiles` tiles along x, y and z; the cells of each tile
+ * are computed from its points and a halo of `halo` around it, or twice the
+ * mean spacing of the points if 0, which is widened for the cells that may
+ * reach past it. The file is read through a memory map and only the indices
+ * of the points, sorted by tile, and the points of one tile and its halo are
+ * held at once. Records are written tile by tile, so `format` must be
+ * VORO3D_STREAM_GEOJSON or VORO3D_STREAM_CSV, whose records hold the point
+ * ids; points with missing coordinates have none. The radius and the
+ * anisotropy of `options` are not supported. Unless `computed` is NULL, it
+ * receives the number of cells computed. */
+int voro3d_stream_tiles( const char* path,
+                         const voro3d_options* options,
+                         const int* tiles,
+                         double halo,
+                         int format,
+                         FILE* file,
+                         size_t* computed );
+
+void voro3d_free( voro3d_result* result );
+
+/* Locate the `query_count` points `qx`, `qy` and `qz` in the cells of the `n`
+ * points `x`, `y` and `z` without computing the cells. `index` receives the
+ * 0-based id of the nearest point of each query, or -1 for queries with
+ * non-finite coordinates, and `distance` the distance to it, or NaN. Only the
+ * threads, grid, blocks and init_mem of `options` are used. */
+int voro3d_locate( const double* x, const double* y, const double* z,
+                   size_t n,
+                   const double* qx, const double* qy, const double* qz,
+                   size_t query_count,
+                   const voro3d_options* options,
+                   int* index, double* distance );
+
+/* Description of the last error on the calling thread */
+const char* voro3d_last_error( void );
+
+/* Number of cells, equal to the number of points */
+size_t voro3d_cells( const voro3d_result* result );
+
+/* Non-zero if the cell of point `id` could be computed */
+int voro3d_computed( const voro3d_result* result, size_t id );
+
+/* Well-known text of a cell, or NULL if the cell was not computed or the
+ * output is not VORO3D_WKT. The text is not terminated by a null character. */
+const char* voro3d_wkt( const voro3d_result* result, size_t id,
+                        size_t* length );
+
+/* Well-known binary of a cell, or NULL if the cell was not computed or the
+ * output is not VORO3D_WKB */
+const unsigned char* voro3d_wkb( const voro3d_result* result, size_t id,
+                                 size_t* length );
+
+/* Volume of a cell, or NaN if the cell was not computed or the output is not
+ * VORO3D_VOLUME */
+double voro3d_volume( const voro3d_result* result, size_t id );
+
+/* Mesh of a cell for the VORO3D_MESH output: `vertex_count` vertices stored at
+ * every 3 elements of `vertices`, and `face_count` faces whose sizes are in
+ * `face_sizes` and whose 0-based vertex indices follow each other in
+ * `faces`. Returns 0 if the cell was not computed or the output is not
+ * VORO3D_MESH. */
+int voro3d_mesh( const voro3d_result* result, size_t id,
+                 const double** vertices, int* vertex_count,
+                 const int** faces, const int** face_sizes, int* face_count );
+
+/* Neighbours of a cell for the VORO3D_ADJACENCY output: the 0-based id of the
+ * point across each of its `face_count` faces, or a negative id for the
+ * container (-1 to -6) and the walls, and the area of each face. Returns 0 if
+ * the cell was not computed or the output is not VORO3D_ADJACENCY. */
+int voro3d_adjacency( const voro3d_result* result, size_t id,
+                      const int** neighbours, const double** areas,
+                      int* face_count );
+
+/* Blocks overlapped by a cell for the VORO3D_BLOCKS output: the index of each
+ * of the `block_count` blocks, in increasing order, and the volume of the
+ * cell within it. Returns 0 if the cell was not computed or the output is not
+ * VORO3D_BLOCKS. */
+int voro3d_blocks( const voro3d_result* result, size_t id,
+                   const int** blocks, const double** volumes,
+                   int* block_count );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
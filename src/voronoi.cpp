@@ -1,21 +1,522 @@
+#include <algorithm>
+#include <climits>
 #include <math.h>
 #include <stdio.h>
+#include <string>
+#include <vector>
 #include <Rcpp.h>
-#include <voro++.hh>
 
-#include "dirVector.h"
+#include "diagram.h"
+#include "engine.h"
+#include "locate.h"
+#include "profile.h"
+#include "tiles.h"
+#include "wktVector.h"
 
-// If ever x  is too small, use a threshold value for the dimensions of the
-// container.
-double setThreshold ( double x )
+// R interface to the engine in engine.h
+
+// Points of the coordinate vectors, which must have the same length
+Points checkPoints( Rcpp::NumericVector& x,
+                    Rcpp::NumericVector& y,
+                    Rcpp::NumericVector& z )
 {
-  // Hard coded threshold is 2 meters
-  const double threshold = 2;
+  R_xlen_t n = x.length();
 
-  if ( x < threshold )
-    return threshold;
-  else
-    return x;
+  if ( n != y.length() || n != z.length() )
+    Rcpp::stop( "Lengths of coordinate vectors are not equal." );
+
+  return Points { x.begin(), y.begin(), z.begin(), size_t( n ) };
+}
+
+// Set the radii of `points` from the `radius` argument of the R functions
+void pointRadii( Points& points, Rcpp::Nullable< Rcpp::NumericVector > radius )
+{
+  if ( radius.isNull() )
+    return;
+
+  Rcpp::NumericVector values ( radius );
+  if ( size_t( values.length() ) != points.n )
+    Rcpp::stop( "Invalid radius: Length of radius must match the number of points." );
+
+  points.radius = values.begin();
+}
+
+// Grid of the container from the arguments of the R functions
+GridOptions gridOptions( std::string grid,
+                         Rcpp::Nullable< Rcpp::IntegerVector > blocks,
+                         int initMem )
+{
+  GridOptions options;
+  options.mode = gridMode( grid );
+  options.initMem = initMem;
+
+  if ( blocks.isNotNull() )
+  {
+    Rcpp::IntegerVector counts ( blocks );
+    if ( counts.length() != 3 )
+      Rcpp::stop( "Invalid blocks: Value must be three positive integers." );
+
+    for ( int a = 0; a < 3; a++ )
+    {
+      options.blocks[a] = counts[a];
+      if ( counts[a] < 1 )
+        Rcpp::stop( "Invalid blocks: Value must be three positive integers." );
+    }
+  }
+
+  return options;
+}
+
+// Rows of `columns` numbers of the element `name` of `list`, given as a
+// matrix or, for a single row, a vector
+Rcpp::NumericMatrix wallRows( Rcpp::List list,
+                              const char* name,
+                              int columns,
+                              const char* message )
+{
+  SEXP value = list[name];
+  if ( !Rf_isNumeric( value ) )
+    Rcpp::stop( message );
+
+  if ( !Rf_isMatrix( value ) )
+  {
+    Rcpp::NumericVector row ( value );
+    if ( row.length() != columns )
+      Rcpp::stop( message );
+
+    Rcpp::NumericMatrix rows ( 1, columns );
+    for ( int j = 0; j < columns; j++ )
+      rows( 0, j ) = row[j];
+    return rows;
+  }
+
+  Rcpp::NumericMatrix rows ( value );
+  if ( rows.ncol() != columns )
+    Rcpp::stop( message );
+  return rows;
+}
+
+// Walls from the `walls` argument of the R functions
+Walls wallOptions( Rcpp::Nullable< Rcpp::List > walls )
+{
+  Walls options;
+  if ( walls.isNull() )
+    return options;
+
+  Rcpp::List list ( walls );
+  Rcpp::CharacterVector names = list.names();
+  for ( R_xlen_t i = 0; i < list.length(); i++ )
+  {
+    std::string name = i < names.length() ? std::string( names[i] ) : "";
+    if ( name != "planes" && name != "prism" && name != "cylinders" )
+      Rcpp::stop( "Invalid walls: Elements must be named \"planes\", \"prism\" or \"cylinders\"." );
+  }
+
+  if ( list.containsElementNamed( "planes" ) )
+  {
+    Rcpp::NumericMatrix planes = wallRows(
+      list, "planes", 4, "Invalid planes: Value must be a matrix with 4 columns." );
+    for ( int i = 0; i < planes.nrow(); i++ )
+    {
+      options.planes.push_back( PlaneWall { planes( i, 0 ), planes( i, 1 ),
+                                            planes( i, 2 ), planes( i, 3 ) } );
+    }
+  }
+
+  if ( list.containsElementNamed( "prism" ) )
+  {
+    Rcpp::List prism = list["prism"];
+    if ( !prism.containsElementNamed( "x" ) || !prism.containsElementNamed( "y" ) ||
+         !prism.containsElementNamed( "z" ) )
+      Rcpp::stop( "Invalid prism: Value must be a list with x, y and z." );
+
+    Rcpp::NumericVector x = prism["x"], y = prism["y"], z = prism["z"];
+    if ( x.length() != y.length() || z.length() != 2 )
+      Rcpp::stop( "Invalid prism: x and y must have the same length and z must have 2 values." );
+
+    addPrism( x.begin(), y.begin(), x.length(), z[0], z[1], options );
+  }
+
+  if ( list.containsElementNamed( "cylinders" ) )
+  {
+    Rcpp::NumericMatrix cylinders = wallRows(
+      list, "cylinders", 7, "Invalid cylinders: Value must be a matrix with 7 columns." );
+    for ( int i = 0; i < cylinders.nrow(); i++ )
+    {
+      options.cylinders.push_back(
+        CylinderWall { cylinders( i, 0 ), cylinders( i, 1 ), cylinders( i, 2 ),
+                       cylinders( i, 3 ), cylinders( i, 4 ), cylinders( i, 5 ),
+                       cylinders( i, 6 ) } );
+    }
+  }
+
+  return options;
+}
+
+// Ellipsoid from three `ranges`, or a radius if `radius` is true, and three
+// `angles`, as given to the option `name` of the R functions
+Ellipsoid ellipsoidOptions( Rcpp::Nullable< Rcpp::NumericVector > ranges,
+                            Rcpp::NumericVector angles,
+                            const std::string& name,
+                            bool radius )
+{
+  Ellipsoid ellipsoid;
+  if ( ranges.isNull() )
+    return ellipsoid;
+
+  Rcpp::NumericVector values ( ranges );
+  if ( radius && values.length() != 1 && values.length() != 3 )
+    Rcpp::stop( "Invalid " + name + ": Value must be a radius or three ranges." );
+
+  if ( !radius && values.length() != 3 )
+    Rcpp::stop( "Invalid " + name + ": Value must be three ranges." );
+
+  if ( angles.length() != 3 )
+    Rcpp::stop( "Invalid " + name + "Angles: Value must be three angles in degrees." );
+
+  for ( int a = 0; a < 3; a++ )
+  {
+    ellipsoid.ranges[a] = values[values.length() == 1 ? 0 : a];
+    ellipsoid.angles[a] = angles[a];
+  }
+
+  return ellipsoid;
+}
+
+// Spacing of the regularly spaced, increasing `values`, or 0 if they are not
+double gridSpacing( Rcpp::NumericVector values )
+{
+  R_xlen_t n = values.length();
+  if ( n < 2 )
+    return 0;
+
+  double spacing = ( values[n - 1] - values[0] ) / ( n - 1 );
+  for ( R_xlen_t i = 1; i < n; i++ )
+  {
+    if ( !( fabs( values[i] - values[0] - i * spacing ) <= 1e-6 * spacing ) )
+      return 0;
+  }
+
+  return spacing;
+}
+
+// Elevation model from the `dem` argument of the R functions
+Dem demOptions( Rcpp::Nullable< Rcpp::List > dem )
+{
+  Dem options;
+  if ( dem.isNull() )
+    return options;
+
+  Rcpp::List list ( dem );
+  if ( !list.containsElementNamed( "x" ) || !list.containsElementNamed( "y" ) ||
+       !list.containsElementNamed( "z" ) )
+    Rcpp::stop( "Invalid dem: Value must be a list with x, y and z." );
+
+  Rcpp::NumericVector x = list["x"], y = list["y"];
+  SEXP z = list["z"];
+  if ( !Rf_isMatrix( z ) || !Rf_isNumeric( z ) )
+    Rcpp::stop( "Invalid dem: z must be a numeric matrix." );
+
+  Rcpp::NumericMatrix elevations ( z );
+  if ( elevations.nrow() != x.length() || elevations.ncol() != y.length() )
+    Rcpp::stop( "Invalid dem: z must have length(x) rows and length(y) columns." );
+
+  options.dx = gridSpacing( x );
+  options.dy = gridSpacing( y );
+  if ( !( options.dx > 0 ) || !( options.dy > 0 ) )
+    Rcpp::stop( "Invalid dem: x and y must be increasing and regularly spaced." );
+
+  options.x0 = x[0];
+  options.y0 = y[0];
+  options.nx = x.length();
+  options.ny = y.length();
+  options.z.assign( elevations.begin(), elevations.end() );
+  return options;
+}
+
+// Block model from the `blockModel` argument of the R functions
+BlockModel blockModelOptions( Rcpp::Nullable< Rcpp::List > blockModel )
+{
+  BlockModel model;
+  if ( blockModel.isNull() )
+    return model;
+
+  Rcpp::List list ( blockModel );
+  if ( !list.containsElementNamed( "origin" ) || !list.containsElementNamed( "size" ) ||
+       !list.containsElementNamed( "count" ) )
+    Rcpp::stop( "Invalid blockModel: Value must be a list with origin, size and count." );
+
+  Rcpp::NumericVector origin = list["origin"], size = list["size"], count = list["count"];
+  if ( origin.length() != 3 || size.length() != 3 || count.length() != 3 )
+    Rcpp::stop( "Invalid blockModel: origin, size and count must have three values." );
+
+  for ( int a = 0; a < 3; a++ )
+  {
+    if ( !( count[a] >= 1 && count[a] <= INT_MAX ) || count[a] != floor( count[a] ) )
+      Rcpp::stop( "Invalid blockModel: Block counts must be positive." );
+
+    model.origin[a] = origin[a];
+    model.size[a] = size[a];
+    model.count[a] = int( count[a] );
+  }
+
+  return model;
+}
+
+// Compute the cells of `points`, separately for each group if `group` is not
+// NULL. Groups are matched like `unique()` does, except that points whose group
+// is NA are in no group.
+void computePoints( const Points& points,
+                    Rcpp::RObject group,
+                    const CellOptions& options,
+                    CellOutput& output )
+{
+  if ( group.isNULL() )
+  {
+    computeOutput( points, options, output );
+    return;
+  }
+
+  if ( Rf_xlength( group ) != R_xlen_t( points.n ) )
+    Rcpp::stop( "Length of group is not equal to the number of points." );
+
+  Rcpp::Function match ( "match" ), unique ( "unique" );
+  Rcpp::IntegerVector codes = match(
+    group, unique( group ),
+    Rcpp::Named( "incomparables" ) = Rcpp::LogicalVector::create( NA_LOGICAL ) );
+
+  computeOutput( points, pointGroups( codes.begin(), codes.length() ),
+                 options, output );
+}
+
+// Gather the cells of all chunks in particle order into a list with a vertex
+// coordinate matrix and compressed sparse row face and cell indices
+Rcpp::List meshList( const std::vector< MeshChunk >& chunks,
+                     const std::vector< MeshSlot >& slots )
+{
+  double vertexCount = 0, faceCount = 0, indexCount = 0;
+  for ( const MeshSlot& slot : slots )
+  {
+    vertexCount += slot.vertices;
+    faceCount += slot.faces;
+    indexCount += slot.indices;
+  }
+
+  if ( vertexCount > INT_MAX || indexCount > INT_MAX )
+    Rcpp::stop( "Mesh is too large to be indexed with integers." );
+
+  R_xlen_t cells = slots.size();
+  Rcpp::NumericMatrix vertices ( (int) vertexCount, 3 );
+  Rcpp::IntegerVector faces ( (R_xlen_t) indexCount );
+  Rcpp::IntegerVector faceOffsets ( (R_xlen_t) faceCount + 1 );
+  Rcpp::IntegerVector cellOffsets ( cells + 1 );
+
+  int vertex = 0, face = 0, index = 0;
+  faceOffsets[0] = 0;
+  cellOffsets[0] = 0;
+
+  for ( R_xlen_t cell = 0; cell < cells; cell++ )
+  {
+    const MeshSlot& slot = slots[cell];
+    if ( slot.thread >= 0 )
+    {
+      const MeshChunk& chunk = chunks[slot.thread];
+
+      for ( int v = 0; v < slot.vertices; v++ )
+      {
+        vertices( vertex + v, 0 ) = chunk.vertices[slot.vertex + 3 * v];
+        vertices( vertex + v, 1 ) = chunk.vertices[slot.vertex + 3 * v + 1];
+        vertices( vertex + v, 2 ) = chunk.vertices[slot.vertex + 3 * v + 2];
+      }
+
+      // Indices are 1-based rows of `vertices`
+      for ( int i = 0; i < slot.indices; i++ )
+        faces[index + i] = vertex + chunk.faces[slot.face + i] + 1;
+
+      for ( int f = 0; f < slot.faces; f++ )
+      {
+        index += chunk.faceSizes[slot.faceSize + f];
+        faceOffsets[face + f + 1] = index;
+      }
+
+      vertex += slot.vertices;
+      face += slot.faces;
+    }
+
+    cellOffsets[cell + 1] = face;
+  }
+
+  return Rcpp::List::create( Rcpp::Named( "vertices" ) = vertices,
+                             Rcpp::Named( "faces" ) = faces,
+                             Rcpp::Named( "faceOffsets" ) = faceOffsets,
+                             Rcpp::Named( "cellOffsets" ) = cellOffsets );
+}
+
+// Gather the neighbours of the cells of all chunks in particle order into
+// compressed sparse rows, with 1-based point indices
+Rcpp::List adjacencyList( const std::vector< AdjacencyChunk >& chunks,
+                          const std::vector< AdjacencySlot >& slots )
+{
+  double faceCount = 0;
+  for ( const AdjacencySlot& slot : slots )
+    faceCount += slot.faces;
+
+  if ( faceCount > INT_MAX )
+    Rcpp::stop( "Adjacency is too large to be indexed with integers." );
+
+  R_xlen_t cells = slots.size();
+  Rcpp::IntegerVector offsets ( cells + 1 );
+  Rcpp::IntegerVector neighbours ( (R_xlen_t) faceCount );
+  Rcpp::NumericVector areas ( (R_xlen_t) faceCount );
+
+  int face = 0;
+  offsets[0] = 0;
+  for ( R_xlen_t cell = 0; cell < cells; cell++ )
+  {
+    const AdjacencySlot& slot = slots[cell];
+    if ( slot.thread >= 0 )
+    {
+      const AdjacencyChunk& chunk = chunks[slot.thread];
+      for ( int f = 0; f < slot.faces; f++ )
+      {
+        int neighbour = chunk.neighbours[slot.face + f];
+        neighbours[face + f] = neighbour >= 0 ? neighbour + 1 : neighbour;
+        areas[face + f] = chunk.areas[slot.face + f];
+      }
+      face += slot.faces;
+    }
+
+    offsets[cell + 1] = face;
+  }
+
+  return Rcpp::List::create( Rcpp::Named( "offsets" ) = offsets,
+                             Rcpp::Named( "neighbours" ) = neighbours,
+                             Rcpp::Named( "areas" ) = areas );
+}
+
+// Gather the blocks of the cells of all chunks in particle order into a data
+// frame with 1-based cell and block indices
+Rcpp::DataFrame blockFrame( const std::vector< BlockChunk >& chunks,
+                            const std::vector< BlockSlot >& slots )
+{
+  double partCount = 0;
+  for ( const BlockSlot& slot : slots )
+    partCount += slot.parts;
+
+  if ( partCount > INT_MAX )
+    Rcpp::stop( "Blocks are too many to be indexed with integers." );
+
+  Rcpp::IntegerVector cells ( (R_xlen_t) partCount );
+  Rcpp::IntegerVector blocks ( (R_xlen_t) partCount );
+  Rcpp::NumericVector volumes ( (R_xlen_t) partCount );
+
+  int part = 0;
+  for ( size_t cell = 0; cell < slots.size(); cell++ )
+  {
+    const BlockSlot& slot = slots[cell];
+    if ( slot.thread < 0 )
+      continue;
+
+    const BlockChunk& chunk = chunks[slot.thread];
+    for ( int p = 0; p < slot.parts; p++ )
+    {
+      cells[part + p] = int( cell ) + 1;
+      blocks[part + p] = chunk.blocks[slot.part + p] + 1;
+      volumes[part + p] = chunk.volumes[slot.part + p];
+    }
+    part += slot.parts;
+  }
+
+  return Rcpp::DataFrame::create( Rcpp::Named( "cell" ) = cells,
+                                  Rcpp::Named( "block" ) = blocks,
+                                  Rcpp::Named( "volume" ) = volumes );
+}
+
+// Move the cells of `output` into an R object. The geometry of each cell is
+// released as soon as it has been copied.
+SEXP outputObject( CellOutput& output )
+{
+  R_xlen_t n = output.computed.size();
+
+  if ( output.format == OUTPUT_MESH )
+    return meshList( output.chunks, output.slots );
+
+  if ( output.format == OUTPUT_ADJACENCY )
+    return adjacencyList( output.adjacency, output.adjacencySlots );
+
+  if ( output.format == OUTPUT_BLOCKS )
+    return blockFrame( output.blocks, output.blockSlots );
+
+  if ( output.format == OUTPUT_VOLUME )
+  {
+    Rcpp::NumericVector volume ( n );
+    for ( R_xlen_t i = 0; i < n; i++ )
+      volume[i] = output.computed[i] ? output.volume[i] : NA_REAL;
+    return volume;
+  }
+
+  if ( output.format == OUTPUT_WKB )
+  {
+    Rcpp::List cellBinary ( n );
+    for ( R_xlen_t i = 0; i < n; i++ )
+    {
+      std::vector< unsigned char >& binary = output.wkb[i];
+      if ( output.computed[i] )
+      {
+        cellBinary[i] = Rcpp::RawVector( binary.begin(), binary.end() );
+        std::vector< unsigned char >().swap( binary );
+      }
+
+      else
+        cellBinary[i] = R_NilValue;
+    }
+    return cellBinary;
+  }
+
+  Rcpp::StringVector cellGeometry ( n );
+  for ( R_xlen_t i = 0; i < n; i++ )
+  {
+    if ( output.computed[i] )
+    {
+      cellGeometry[i] = output.wkt[i];
+      std::string().swap( output.wkt[i] );
+    }
+
+    else
+      cellGeometry[i] = NA_STRING;
+  }
+  return cellGeometry;
+}
+
+// R object of the cells computed by `voronoi()` with `options`
+SEXP voronoiObject( CellOutput& cells, const CellOptions& options )
+{
+  if ( options.deferText )
+    return wktVector( cells, options.polygons, options.precision, options.threads );
+
+  return outputObject( cells );
+}
+
+// Profile of a run as an R list. `assign` is the time spent creating the R
+// object from the output of the engine.
+Rcpp::List profileList( const RunProfile& profile, double assign )
+{
+  Rcpp::NumericVector seconds = Rcpp::NumericVector::create(
+    Rcpp::Named( "put" ) = profile.put,
+    Rcpp::Named( "compute" ) = profile.compute,
+    Rcpp::Named( "walk" ) = profile.walk,
+    Rcpp::Named( "write" ) = profile.write,
+    Rcpp::Named( "assign" ) = assign,
+    Rcpp::Named( "total" ) = profile.total + assign );
+
+  return Rcpp::List::create(
+    Rcpp::Named( "seconds" ) = seconds,
+    Rcpp::Named( "threads" ) = profile.threads,
+    Rcpp::Named( "blocks" ) = Rcpp::IntegerVector( profile.blocks, profile.blocks + 3 ),
+    Rcpp::Named( "cells" ) = profile.cells,
+    Rcpp::Named( "failed" ) = profile.failed,
+    Rcpp::Named( "scratchBytes" ) = profile.scratchBytes,
+    Rcpp::Named( "outputBytes" ) = profile.outputBytes );
 }
 
 //' Create Voronoi Diagram
@@ -23,187 +524,796 @@ double setThreshold ( double x )
 //' Create cell-based voronoi diagram using three-dimensional points. The
 //'   polyhedral surface of each cell is defined in well-known text format.
 //'
+//' With \code{output = "wkt"}, the text of a cell is written only when it is
+//'   read, except that \code{is.na()} writes the text of every cell: R reads
+//'   each element to answer it, with no way for the vector to answer without
+//'   the text. \code{anyNA()} writes no text, and \code{voronoi_volume()}
+//'   tells which cells could not be computed.
+//'
 //' @param x numeric vector of the x-coordinates of the points
 //' @param y numeric vector of the y-coordinates of the points
 //' @param z numeric vector of the z-coordinates of the points
 //' @param containerRatio numeric ratio between the length of the container to
 //'   be created and the length of the bounding box of the points
-//' @return character vector defining the voronoi cells (polyhedral surface)
-//'   in well-known text
+//' @param threads integer number of threads used to compute the cells. The
+//'   result does not depend on the number of threads.
+//' @param output character string selecting the format of the result:
+//'   \code{"wkt"}, \code{"wkb"}, \code{"mesh"}, \code{"volume"},
+//'   \code{"adjacency"} or \code{"blocks"}
+//' @param polygons logical, if \code{TRUE} each face of a cell is written as
+//'   one polygon instead of a fan of triangles
+//' @param precision integer number of decimals of the coordinates in
+//'   well-known text. If negative or \code{NA}, each coordinate is written with
+//'   the fewest digits that read back to the same number.
+//' @param profile logical, if \code{TRUE} the result gets a \code{"profile"}
+//'   attribute with the time spent in each phase and counts of cells and
+//'   bytes. Profiling adds no cost when \code{FALSE}.
+//' @param grid character string selecting how the container is divided into
+//'   blocks for the neighbour search. \code{"uniform"} sizes cubic blocks for
+//'   uniformly spread points. \code{"tuned"} scales the cubic blocks from a
+//'   histogram of the number of points per block, and \code{"anisotropic"}
+//'   sizes the blocks separately along each axis, which suits clustered points
+//'   such as drill hole composites. Both also size the memory of each block
+//'   from its number of points. The cells do not depend on the grid, except
+//'   for rounding in the last digits and the order of the faces.
+//' @param blocks \code{NULL} or integer vector of the number of blocks along
+//'   x, y and z, overriding the ones chosen by \code{grid}. Meant for
+//'   benchmarking.
+//' @param initMem integer initial number of points that each block can hold,
+//'   overriding the one chosen by \code{grid}, or 0 to let \code{grid}
+//'   choose. Meant for benchmarking.
+//' @param group \code{NULL} or vector (e.g. character, factor or integer) of
+//'   the group of each point, such as its geological domain. If given, the
+//'   diagram of each group is computed as if \code{voronoi()} was called on
+//'   the points of the group alone, and the groups are processed
+//'   concurrently. Cells are still returned in the order of the points.
+//'   Cells of points whose group is \code{NA} or has a single point are not
+//'   computed.
+//' @param walls \code{NULL} or named list of walls that bound the cells within
+//'   the container, with any of the elements \code{planes}, a matrix whose
+//'   rows \code{c(a, b, c, d)} are the half-spaces
+//'   \eqn{a x + b y + c z \le d}; \code{prism}, a list with the vertices
+//'   \code{x} and \code{y} of a convex polygon and the range \code{z}, such as
+//'   a lease or pit limit between two elevations; and \code{cylinders}, a
+//'   matrix whose rows \code{c(x, y, z, dx, dy, dz, radius)} are a point on the
+//'   axis, the direction of the axis and the radius of a cylinder. The cells
+//'   are clipped while they are computed, which also shortens the search for
+//'   their neighbours. A cylinder cuts each cell by the plane tangent to it
+//'   nearest to the point of the cell. The cell of a point outside of the walls
+//'   is the part of its voronoi cell inside the walls, if any, so the cells
+//'   still fill the space within the walls.
+//' @param dem \code{NULL} or digital elevation model as a list with the
+//'   increasing, regularly spaced coordinates \code{x} and \code{y} of the
+//'   grid nodes and the matrix \code{z} of their elevations, as used by
+//'   \code{image()}. The cells are clipped by the terrain through the nodes,
+//'   made of two triangles per grid square, keeping their part below it. Cells
+//'   below the lowest node under them are not cut, so only cells crossing the
+//'   terrain pay for clipping. Cells entirely above the terrain are not
+//'   computed and parts of cells beyond the grid are kept whole. A clipped cell
+//'   is written as the faces of the convex pieces it is made of, one per
+//'   triangle of the terrain it crosses, without the faces between pieces.
+//' @param maxRadius \code{NULL}, or the largest distance from its point that a
+//'   cell may reach, or the ranges of an ellipsoid along its major, semi-major
+//'   and minor axes. Each cell is clipped by the sphere or ellipsoid centred on
+//'   its point, which keeps the cells of points at the edge of the data from
+//'   reaching the container and shortens the search for neighbours. The
+//'   ellipsoid is approximated by 192 tangent planes scaled to its volume, so
+//'   that the volume of a cell within the ellipsoid is exact and its surface is
+//'   within 1.5\% of the ellipsoid.
+//' @param maxRadiusAngles numeric vector of the rotation of the ellipsoid of
+//'   \code{maxRadius} in degrees: the strike, azimuth of the major axis
+//'   clockwise from the y axis; the dip of the major axis below the horizontal;
+//'   and the plunge, rotation of the semi-major and minor axes about the major
+//'   axis. Without rotation the axes are along y, x and z.
+//' @param anisotropy \code{NULL} or numeric vector of the ranges of continuity
+//'   of the data along the major, semi-major and minor axes, such as the
+//'   ranges of a variogram. The points are mapped to the space where the
+//'   ellipsoid of these ranges is a sphere as they are inserted in the
+//'   container, and the vertices and volumes of the cells are mapped back as
+//'   they are written, so the cells reach further along the longer ranges.
+//'   \code{containerRatio} applies to the bounding box of the mapped points,
+//'   and \code{maxRadius} and the planes of \code{walls} to the original
+//'   coordinates. Cannot be combined with cylinders or \code{dem}.
+//' @param anisotropyAngles numeric vector of the strike, dip and plunge of the
+//'   anisotropy ellipsoid in degrees, as for \code{maxRadiusAngles}.
+//' @param radius \code{NULL} or numeric vector of the radius of each point,
+//'   such as the support of each composite. If given, the cells are those of
+//'   the power (Laguerre) diagram: the plane between two points moves away
+//'   from the point with the larger radius, so larger points get larger
+//'   cells, and the cells still fill the container. A point whose radius is
+//'   small compared with its neighbours can get no cell or a cell that does
+//'   not contain it. With \code{anisotropy}, the radii are lengths in the
+//'   space where the anisotropy ellipsoid is a sphere of the major range.
+//' @param blockModel \code{NULL} or, for \code{output = "blocks"}, list of
+//'   the regular block model by which the cells are split: \code{origin},
+//'   the lower corner of its first block, \code{size}, the size of the blocks
+//'   and \code{count}, the number of blocks, each along x, y and z.
+//' @return If \code{output} is \code{"wkt"}, character vector defining the
+//'   voronoi cells (polyhedral surface) in well-known text. The vector keeps
+//'   the geometry of the cells, which is several times smaller than its text,
+//'   and writes the text of an element only when it is read, so
+//'   \code{length()}, subsets and \code{anyNA()} write no text.
+//'   \code{is.na()} and other functions that read each element write them
+//'   one at a time without keeping them, and functions that need the whole
+//'   vector, such as \code{writeLines()}, write all elements at once on
+//'   \code{threads} threads.
+//'
+//'   If \code{output} is \code{"wkb"}, list of raw vectors holding the same
+//'   polyhedral surfaces in ISO well-known binary with Z coordinates. Cells
+//'   that could not be computed are \code{NULL}.
+//'
+//'   If \code{output} is \code{"mesh"}, list of the cells in compressed sparse
+//'   row form: \code{vertices} is the matrix of vertex
+//'   coordinates, \code{faces} holds the (1-based) rows of \code{vertices}
+//'   of each face, face \code{f} uses the elements
+//'   \code{(faceOffsets[f] + 1):faceOffsets[f + 1]} of \code{faces} and
+//'   cell \code{i} owns the faces
+//'   \code{(cellOffsets[i] + 1):cellOffsets[i + 1]}. Cells that could not be
+//'   computed have no faces.
+//'
+//'   If \code{output} is \code{"volume"}, the result of
+//'   \code{voronoi_volume()}.
+//'
+//'   If \code{output} is \code{"adjacency"}, list of the neighbours of the
+//'   cells in compressed sparse row form: cell \code{i} owns the elements
+//'   \code{(offsets[i] + 1):offsets[i + 1]} of \code{neighbours}, the index of
+//'   the point across each face, and \code{areas}, the area of the face. Faces
+//'   on the container have the negative ids \code{-1} to \code{-6} (lower and
+//'   upper x, y and z), faces on \code{walls} have \code{-7} downwards in the
+//'   order of the planes, prism and cylinders, and faces cut by
+//'   \code{maxRadius} have \code{-1000002}. Cells that could not be computed
+//'   have no faces. Cannot be combined with \code{dem}. For example,
+//'   \code{Matrix::sparseMatrix(i = rep(seq_along(x), diff(offsets)), j =
+//'   neighbours, x = areas)} after dropping the negative ids gives the
+//'   contact areas between cells.
+//'
+//'   If \code{output} is \code{"blocks"}, data frame of the volume of each
+//'   cell within each block of \code{blockModel} that it overlaps, ordered by
+//'   \code{cell}, the index of the point, and \code{block}, the index of the
+//'   block: block \code{(i, j, k)}, counted from 1 along x, y and z, has the
+//'   index \code{i + count[1] * (j - 1 + count[2] * (k - 1))}. Only the blocks
+//'   within the bounding box of each cell are visited, and parts of the cells
+//'   outside of the model are left out, so the volumes of a cell sum to its
+//'   volume if it is inside the model. Cannot be combined with \code{dem}.
+//'
+//'   The \code{"profile"} attribute is a list with \code{seconds}, the time
+//'   spent sizing the grid and inserting the points into the container
+//'   (\code{put}), computing
+//'   the cells (\code{compute}), walking their faces (\code{walk}), writing
+//'   the geometry (\code{write}) and assigning it to the result
+//'   (\code{assign}), and the elapsed time of the whole run
+//'   (\code{total}); \code{cells} and \code{failed}, the number of cells
+//'   attempted and the number that could not be computed;
+//'   \code{blocks}, the number of blocks of the container along each axis
+//'   (of the largest group if \code{group} is given);
+//'   \code{scratchBytes}, the peak scratch space of all threads; and
+//'   \code{outputBytes}, the size of the geometry before it is copied into
+//'   the result. For \code{"wkt"}, the text is written after the run, so
+//'   \code{write} is the time spent storing the geometry kept by the result
+//'   and \code{outputBytes} is its size. \code{put}, \code{compute}, \code{walk} and \code{write}
+//'   are summed over threads.
 //' @export
 // [[Rcpp::export]]
-Rcpp::StringVector voronoi( Rcpp::NumericVector x,
-                            Rcpp::NumericVector y,
-                            Rcpp::NumericVector z,
-                            double containerRatio )
-{
-  DirVector point, vO, vA, vB, vC;
-  double cells, i, j, k;
-  double xLength, yLength, zLength;
-  double xMin, xMax, yMin, yMax, zMin, zMax;
-  double conMarginX, conMarginY, conMarginZ;
-  double conXMin, conXMax, conYMin, conYMax, conZMin, conZMax;
-  int ii, jj, kk, ll, mm, nn, nx, ny, nz;
-  R_xlen_t n, cGCount;
-  std::string polygon, polyhedralsurface;
-  std::vector< DirVector > points;
-  std::vector< double > vertices;
-  std::vector< int > faceVertices;
-  std::vector< int > vertexOrder;
-  voro::voronoicell vc;
-  voro::particle_order po;
-  voro::wall_list wl;
-
-  n = x.length();
+SEXP voronoi( Rcpp::NumericVector x,
+              Rcpp::NumericVector y,
+              Rcpp::NumericVector z,
+              double containerRatio,
+              int threads = 1,
+              std::string output = "wkt",
+              bool polygons = false,
+              int precision = 6,
+              bool profile = false,
+              std::string grid = "uniform",
+              Rcpp::Nullable< Rcpp::IntegerVector > blocks = R_NilValue,
+              int initMem = 0,
+              Rcpp::RObject group = R_NilValue,
+              Rcpp::Nullable< Rcpp::List > walls = R_NilValue,
+              Rcpp::Nullable< Rcpp::List > dem = R_NilValue,
+              Rcpp::Nullable< Rcpp::NumericVector > maxRadius = R_NilValue,
+              Rcpp::NumericVector maxRadiusAngles = Rcpp::NumericVector::create( 0, 0, 0 ),
+              Rcpp::Nullable< Rcpp::NumericVector > anisotropy = R_NilValue,
+              Rcpp::NumericVector anisotropyAngles = Rcpp::NumericVector::create( 0, 0, 0 ),
+              Rcpp::Nullable< Rcpp::NumericVector > radius = R_NilValue,
+              Rcpp::Nullable< Rcpp::List > blockModel = R_NilValue )
+{
+  CellOptions options;
+  CellOutput cells;
+  double assign = 0;
+  Stopwatch< true > stopwatch;
 
-  if ( n != y.length() || n != z.length() )
-    Rcpp::stop( "Lengths of coordinate vectors are not equal." );
+  Points points = checkPoints( x, y, z );
+  pointRadii( points, radius );
+  options.containerRatio = containerRatio;
+  options.threads = threads;
+  options.grid = gridOptions( grid, blocks, initMem );
+  options.walls = wallOptions( walls );
+  options.influence = ellipsoidOptions( maxRadius, maxRadiusAngles, "maxRadius", true );
+  options.anisotropy = ellipsoidOptions( anisotropy, anisotropyAngles, "anisotropy", false );
+  options.dem = demOptions( dem );
+  options.blockModel = blockModelOptions( blockModel );
+  options.output = outputFormat( output );
+  options.polygons = polygons;
+  options.precision = precision;
+  options.deferText = options.output == OUTPUT_WKT;
+  options.profile = profile;
 
-  if ( n < 2 )
-    Rcpp::stop( "Cannot generate cells if points are less than 2." );
+  computePoints( points, group, options, cells );
 
-  if ( containerRatio < 1 )
-    Rcpp::stop( "Invalid containerRatio: Value must not be less than 1." );
+  if ( !profile )
+    return voronoiObject( cells, options );
 
-  Rcpp::StringVector cellGeometry ( n );
-  cGCount = 0;
-
-  // Bounding box vertices
-  xMin = Rcpp::min( x );
-  yMin = Rcpp::min( y );
-  zMin = Rcpp::min( z );
-  xMax = Rcpp::max( x );
-  yMax = Rcpp::max( y );
-  zMax = Rcpp::max( z );
-
-  // Bounding box dimensions
-  xLength = setThreshold( xMax - xMin );
-  yLength = setThreshold( yMax - yMin );
-  zLength = setThreshold( zMax - zMin );
-
-  // Margin of container based on the ratio (multiplying factor)
-  conMarginX = xLength * ( containerRatio - 1 ) / 2;
-  conMarginY = yLength * ( containerRatio - 1 ) / 2;
-  conMarginZ = zLength * ( containerRatio - 1 ) / 2;
-
-  // Container vertices
-  conXMin = xMin - conMarginX;
-  conYMin = yMin - conMarginY;
-  conZMin = zMin - conMarginZ;
-  conXMax = xMax + conMarginX;
-  conYMax = yMax + conMarginY;
-  conZMax = zMax + conMarginZ;
-
-  // Number of divisions per axis
-  cells = cbrt( n / ( 5.6 * xLength * yLength * zLength ) );
-  nx = int( xLength * cells + 1 );
-  ny = int( yLength * cells + 1 );
-  nz = int( zLength * cells + 1 );
-
-  // Initialize container
-  voro::container con( conXMin, conXMax, conYMin, conYMax, conZMin, conZMax,
-                       nx, ny, nz, false, false, false, 8 );
-  con.add_wall( wl );
-
-  // Add points to container
-  for ( R_xlen_t i = 0; i < n; i++ )
-    con.put( po, i, x[i], y[i], z[i] );
+  stopwatch.start();
+  Rcpp::RObject result = voronoiObject( cells, options );
+  stopwatch.lap( assign );
+  result.attr( "profile" ) = profileList( cells.profile, assign );
+  return result;
+}
+
+//' Compute Volumes of Voronoi Cells
+//'
+//' Compute the volume of the voronoi cell of each point without building
+//'   the geometry of the cells. This is much faster than computing the volumes
+//'   from the output of \code{voronoi()}, e.g. for declustering weights.
+//'
+//' @inheritParams voronoi
+//' @return numeric vector of the volume of the cell of each point, in the
+//'   order of the points. The volume is \code{NA} for cells that could not be
+//'   computed.
+//' @export
+// [[Rcpp::export]]
+Rcpp::NumericVector voronoi_volume( Rcpp::NumericVector x,
+                                    Rcpp::NumericVector y,
+                                    Rcpp::NumericVector z,
+                                    double containerRatio,
+                                    int threads = 1,
+                                    std::string grid = "uniform",
+                                    Rcpp::Nullable< Rcpp::IntegerVector > blocks = R_NilValue,
+                                    int initMem = 0,
+                                    Rcpp::RObject group = R_NilValue,
+                                    Rcpp::Nullable< Rcpp::List > walls = R_NilValue,
+                                    Rcpp::Nullable< Rcpp::List > dem = R_NilValue,
+                                    Rcpp::Nullable< Rcpp::NumericVector > maxRadius = R_NilValue,
+                                    Rcpp::NumericVector maxRadiusAngles = Rcpp::NumericVector::create( 0, 0, 0 ),
+                                    Rcpp::Nullable< Rcpp::NumericVector > anisotropy = R_NilValue,
+                                    Rcpp::NumericVector anisotropyAngles = Rcpp::NumericVector::create( 0, 0, 0 ),
+                                    Rcpp::Nullable< Rcpp::NumericVector > radius = R_NilValue )
+{
+  CellOptions options;
+  CellOutput cells;
+
+  Points points = checkPoints( x, y, z );
+  pointRadii( points, radius );
+  options.containerRatio = containerRatio;
+  options.threads = threads;
+  options.grid = gridOptions( grid, blocks, initMem );
+  options.walls = wallOptions( walls );
+  options.influence = ellipsoidOptions( maxRadius, maxRadiusAngles, "maxRadius", true );
+  options.anisotropy = ellipsoidOptions( anisotropy, anisotropyAngles, "anisotropy", false );
+  options.dem = demOptions( dem );
+  options.output = OUTPUT_VOLUME;
+
+  computePoints( points, group, options, cells );
+  return outputObject( cells );
+}
 
-  // Compute voronoi cells
-  voro::c_loop_order clo( con, po );
-  if ( clo.start() )
+//' Write Voronoi Cells to a File
+//'
+//' Compute the voronoi cells and write each of them to a file as soon as it
+//'   is computed, instead of keeping them in memory, for diagrams whose
+//'   geometry does not fit in memory. The memory used is that of the
+//'   container of the points and of the cells being written. The records are
+//'   written in the order of the points, whatever the number of threads: the
+//'   points are handed out to the threads in batches of consecutive points
+//'   and a batch finished ahead of its turn waits for the batches before it.
+//'
+//' @inheritParams voronoi
+//' @param file path of the file, which is overwritten.
+//' @param format \code{"wkt"} to write the well-known text of one cell per
+//'   line, or \code{"POLYHEDRALSURFACE EMPTY"} for the cells that could not
+//'   be computed; \code{"geojson"} to write a GeoJSON text sequence (RFC 8142)
+//'   of one Feature per point, whose \code{id} is the index of the point,
+//'   whose geometry is a MultiPolygon of the faces of the cell, or
+//'   \code{null}, and whose \code{volume} is a property; or \code{"csv"} to
+//'   write the columns \code{id}, \code{wkt} and \code{volume} of each
+//'   point, with \code{NA} for the cells that could not be computed.
+//' @return number of cells written, not counting the cells that could not be
+//'   computed.
+//' @export
+// [[Rcpp::export]]
+double voronoi_write( Rcpp::NumericVector x,
+                      Rcpp::NumericVector y,
+                      Rcpp::NumericVector z,
+                      double containerRatio,
+                      std::string file,
+                      std::string format = "wkt",
+                      int threads = 1,
+                      bool polygons = false,
+                      int precision = 6,
+                      std::string grid = "uniform",
+                      Rcpp::Nullable< Rcpp::IntegerVector > blocks = R_NilValue,
+                      int initMem = 0,
+                      Rcpp::Nullable< Rcpp::List > walls = R_NilValue,
+                      Rcpp::Nullable< Rcpp::List > dem = R_NilValue,
+                      Rcpp::Nullable< Rcpp::NumericVector > maxRadius = R_NilValue,
+                      Rcpp::NumericVector maxRadiusAngles = Rcpp::NumericVector::create( 0, 0, 0 ),
+                      Rcpp::Nullable< Rcpp::NumericVector > anisotropy = R_NilValue,
+                      Rcpp::NumericVector anisotropyAngles = Rcpp::NumericVector::create( 0, 0, 0 ),
+                      Rcpp::Nullable< Rcpp::NumericVector > radius = R_NilValue )
+{
+  CellOptions options;
+  CellStream stream;
+  CellOutput cells;
+
+  Points points = checkPoints( x, y, z );
+  pointRadii( points, radius );
+  options.containerRatio = containerRatio;
+  options.threads = threads;
+  options.grid = gridOptions( grid, blocks, initMem );
+  options.walls = wallOptions( walls );
+  options.influence = ellipsoidOptions( maxRadius, maxRadiusAngles, "maxRadius", true );
+  options.anisotropy = ellipsoidOptions( anisotropy, anisotropyAngles, "anisotropy", false );
+  options.dem = demOptions( dem );
+  options.polygons = polygons;
+  options.precision = precision;
+  stream.format = streamFormat( format );
+
+  stream.file = fopen( R_ExpandFileName( file.c_str() ), "wb" );
+  if ( !stream.file )
+    Rcpp::stop( "Invalid file: Cannot open " + file + "." );
+
+  try
+  {
+    streamOutput( points, options, stream, cells );
+  }
+  catch ( ... )
   {
-    do
+    fclose( stream.file );
+    throw;
+  }
+
+  if ( fclose( stream.file ) != 0 )
+    Rcpp::stop( "Cannot write the file." );
+
+  return std::count( cells.computed.begin(), cells.computed.end(), 1 );
+}
+
+//' Write Voronoi Cells of a Large File Tile by Tile
+//'
+//' Compute the voronoi cells of the points of a binary file one tile at a
+//'   time and write them to a file, for point sets that do not fit in memory.
+//'   The bounding box of the points is split into tiles and the cells of the
+//'   points of each tile are computed from these points and a halo of the
+//'   points around the tile. A cell is kept if no point beyond the halo can
+//'   cut it, i.e. if the sphere around each of its vertices through its point
+//'   stays within the tile and its halo. The other cells are computed again
+//'   with twice the halo, so the cells are those of \code{voronoi_write()} up
+//'   to rounding and the order of their faces. The points are read through a
+//'   memory map and their indices are sorted by tile once, so only the pages
+//'   of the file around one tile and the indices are held in memory at once.
+//'
+//' @inheritParams voronoi_write
+//' @param input path of a binary file of x, y, z triples of doubles in the
+//'   byte order of the machine, e.g. as written by
+//'   \code{writeBin(as.vector(rbind(x, y, z)), input)}.
+//' @param tiles number of tiles along x, y and z.
+//' @param halo width of the halo of points gathered around each tile at
+//'   first, or 0 for twice the mean spacing of the points.
+//' @param format \code{"geojson"} or \code{"csv"}, as for
+//'   \code{voronoi_write()}. The records are written tile by tile and in the
+//'   order of the points within a tile, so their \code{id} tells the point.
+//'   Points with missing coordinates have no record.
+//' @return data frame of one row per tile, x first, then y, then z, with the
+//'   number of \code{points} in the tile, of points \code{gathered} with its
+//'   halo and the width of the \code{halo} in the last round, the number of
+//'   \code{rounds}, of cells \code{recomputed} with a wider halo and of cells
+//'   \code{computed}.
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame voronoi_tiles( std::string input,
+                               std::string file,
+                               double containerRatio,
+                               Rcpp::IntegerVector tiles = Rcpp::IntegerVector::create( 1, 1, 1 ),
+                               double halo = 0,
+                               std::string format = "csv",
+                               int threads = 1,
+                               bool polygons = false,
+                               int precision = 6,
+                               std::string grid = "uniform",
+                               Rcpp::Nullable< Rcpp::IntegerVector > blocks = R_NilValue,
+                               int initMem = 0,
+                               Rcpp::Nullable< Rcpp::List > walls = R_NilValue,
+                               Rcpp::Nullable< Rcpp::List > dem = R_NilValue,
+                               Rcpp::Nullable< Rcpp::NumericVector > maxRadius = R_NilValue,
+                               Rcpp::NumericVector maxRadiusAngles = Rcpp::NumericVector::create( 0, 0, 0 ) )
+{
+  CellOptions options;
+  TileOptions tileOptions;
+  CellStream stream;
+  std::vector< TileReport > reports;
+
+  if ( tiles.length() != 3 )
+    Rcpp::stop( "Invalid tiles: Value must be three positive integers." );
+
+  std::copy( tiles.begin(), tiles.end(), tileOptions.tiles );
+  tileOptions.halo = halo;
+  options.containerRatio = containerRatio;
+  options.threads = threads;
+  options.grid = gridOptions( grid, blocks, initMem );
+  options.walls = wallOptions( walls );
+  options.influence = ellipsoidOptions( maxRadius, maxRadiusAngles, "maxRadius", true );
+  options.dem = demOptions( dem );
+  options.polygons = polygons;
+  options.precision = precision;
+  stream.format = streamFormat( format );
+
+  // Check the options before the output file is overwritten
+  checkTileOptions( tileOptions );
+  std::string path = R_ExpandFileName( input.c_str() );
+
+  stream.file = fopen( R_ExpandFileName( file.c_str() ), "wb" );
+  if ( !stream.file )
+    Rcpp::stop( "Invalid file: Cannot open " + file + "." );
+
+  try
+  {
+    computeTiles( path, tileOptions, options, stream, reports );
+  }
+  catch ( ... )
+  {
+    fclose( stream.file );
+    throw;
+  }
+
+  if ( fclose( stream.file ) != 0 )
+    Rcpp::stop( "Cannot write the file." );
+
+  R_xlen_t count = reports.size();
+  Rcpp::IntegerVector tile ( count ), rounds ( count );
+  Rcpp::NumericVector points ( count ), gathered ( count ), width ( count ),
+    recomputed ( count ), computed ( count );
+  for ( R_xlen_t t = 0; t < count; t++ )
+  {
+    tile[t] = reports[t].tile + 1;
+    points[t] = reports[t].points;
+    gathered[t] = reports[t].gathered;
+    width[t] = reports[t].halo;
+    rounds[t] = reports[t].rounds;
+    recomputed[t] = reports[t].recomputed;
+    computed[t] = reports[t].computed;
+  }
+
+  return Rcpp::DataFrame::create( Rcpp::Named( "tile" ) = tile,
+                                  Rcpp::Named( "points" ) = points,
+                                  Rcpp::Named( "gathered" ) = gathered,
+                                  Rcpp::Named( "halo" ) = width,
+                                  Rcpp::Named( "rounds" ) = rounds,
+                                  Rcpp::Named( "recomputed" ) = recomputed,
+                                  Rcpp::Named( "computed" ) = computed );
+}
+
+// Data frame of the 1-based indices of the located points and their
+// distances, NA for the queries that could not be located
+Rcpp::DataFrame locateFrame( const std::vector< int >& located,
+                             const std::vector< double >& distances )
+{
+  R_xlen_t n = located.size();
+  Rcpp::IntegerVector index ( n );
+  Rcpp::NumericVector distance ( n );
+  for ( R_xlen_t q = 0; q < n; q++ )
+  {
+    index[q] = located[q] < 0 ? NA_INTEGER : located[q] + 1;
+    distance[q] = located[q] < 0 ? NA_REAL : distances[q];
+  }
+
+  return Rcpp::DataFrame::create( Rcpp::Named( "index" ) = index,
+                                  Rcpp::Named( "distance" ) = distance );
+}
+
+//' Locate Points in Voronoi Cells
+//'
+//' Find the voronoi cell that holds each query point, which is the cell of its
+//'   nearest point, e.g. to assign the blocks of a block model to the
+//'   composites that inform them. The cells are not computed, so this is much
+//'   faster than intersecting the queries with the output of
+//'   \code{voronoi()}.
+//'
+//' The queries are sorted by the blocks of the container and the blocks are
+//'   distributed among the threads, so nearby queries are searched one after
+//'   the other. Queries outside of the bounding box of the points are located
+//'   as well.
+//'
+//' @inheritParams voronoi
+//' @param qx numeric vector of x coordinates of the query points.
+//' @param qy numeric vector of y coordinates of the query points.
+//' @param qz numeric vector of z coordinates of the query points.
+//' @return data frame with a row per query: \code{index}, the index of the
+//'   point whose cell holds the query, and \code{distance}, the distance from
+//'   the query to that point. Both are \code{NA} for queries with missing
+//'   coordinates. Ties between points at the same distance go to either
+//'   point.
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame voronoi_locate( Rcpp::NumericVector x,
+                                Rcpp::NumericVector y,
+                                Rcpp::NumericVector z,
+                                Rcpp::NumericVector qx,
+                                Rcpp::NumericVector qy,
+                                Rcpp::NumericVector qz,
+                                int threads = 1,
+                                std::string grid = "uniform" )
+{
+  Points points = checkPoints( x, y, z );
+  Points queries = checkPoints( qx, qy, qz );
+  std::vector< int > located;
+  std::vector< double > distances;
+
+  locatePoints( points, queries, gridOptions( grid, R_NilValue, 0 ), threads,
+                located, distances );
+
+  return locateFrame( located, distances );
+}
+
+// 1-based indices of the changed cells of a diagram
+Rcpp::IntegerVector changedIds( const std::vector< size_t >& changed )
+{
+  Rcpp::IntegerVector ids ( R_xlen_t( changed.size() ) );
+  for ( size_t i = 0; i < changed.size(); i++ )
+    ids[i] = int( changed[i] + 1 );
+  return ids;
+}
+
+// Diagram held by the handle `diagram` returned by voronoi_diagram()
+Diagram& diagramHandle( SEXP diagram )
+{
+  if ( TYPEOF( diagram ) != EXTPTRSXP || !Rf_inherits( diagram, "voronoi_diagram" ) )
+    Rcpp::stop( "Invalid diagram: Value must be the result of voronoi_diagram()." );
+
+  Rcpp::XPtr< Diagram > handle ( diagram );
+  if ( !handle.get() )
+    Rcpp::stop( "Invalid diagram: Handle is no longer valid, e.g. after being saved and loaded." );
+
+  return *handle;
+}
+
+//' Compute a Persistent Voronoi Diagram
+//'
+//' Compute the voronoi cells of the points once and keep them in memory, so
+//'   that many questions can be asked without computing the cells again:
+//'   \code{diagram_cells()} writes the cells of all or some of the points in
+//'   any format of \code{voronoi()}, \code{diagram_locate()} finds the cells
+//'   of query points, \code{diagram_insert()} and \code{diagram_delete()}
+//'   change the points and \code{diagram_info()} summarizes the diagram.
+//'
+//' Each cell is stored as a compact mesh of polygons with the neighbour of
+//'   each face and the volume of the cell, and the diagram holds a container
+//'   of the points for locating queries. The coordinates are copied, so the
+//'   diagram does not change with the vectors it was built from. The handle
+//'   does not survive saving and loading the R session.
+//'
+//' @inheritParams voronoi
+//' @return external pointer of class \code{"voronoi_diagram"}.
+//' @export
+// [[Rcpp::export]]
+SEXP voronoi_diagram( Rcpp::NumericVector x,
+                      Rcpp::NumericVector y,
+                      Rcpp::NumericVector z,
+                      double containerRatio,
+                      int threads = 1,
+                      std::string grid = "uniform",
+                      Rcpp::Nullable< Rcpp::IntegerVector > blocks = R_NilValue,
+                      int initMem = 0,
+                      Rcpp::Nullable< Rcpp::List > walls = R_NilValue,
+                      Rcpp::Nullable< Rcpp::NumericVector > maxRadius = R_NilValue,
+                      Rcpp::NumericVector maxRadiusAngles = Rcpp::NumericVector::create( 0, 0, 0 ),
+                      Rcpp::Nullable< Rcpp::NumericVector > anisotropy = R_NilValue,
+                      Rcpp::NumericVector anisotropyAngles = Rcpp::NumericVector::create( 0, 0, 0 ),
+                      Rcpp::Nullable< Rcpp::NumericVector > radius = R_NilValue )
+{
+  CellOptions options;
+
+  Points points = checkPoints( x, y, z );
+  pointRadii( points, radius );
+  options.containerRatio = containerRatio;
+  options.threads = threads;
+  options.grid = gridOptions( grid, blocks, initMem );
+  options.walls = wallOptions( walls );
+  options.influence = ellipsoidOptions( maxRadius, maxRadiusAngles, "maxRadius", true );
+  options.anisotropy = ellipsoidOptions( anisotropy, anisotropyAngles, "anisotropy", false );
+
+  Rcpp::XPtr< Diagram > diagram ( new Diagram( points, options ), true );
+  diagram.attr( "class" ) = "voronoi_diagram";
+  return diagram;
+}
+
+//' Write the Cells of a Voronoi Diagram
+//'
+//' Write the cells of a diagram computed by \code{voronoi_diagram()}, for all
+//'   points or a subset, without computing them again.
+//'
+//' @inheritParams voronoi
+//' @param diagram result of \code{voronoi_diagram()}.
+//' @param ids \code{NULL} for all points, or integer vector of the indices of
+//'   the points whose cells are written, in that order.
+//' @param output character string selecting the format of the result:
+//'   \code{"wkt"}, \code{"wkb"}, \code{"mesh"}, \code{"volume"} or
+//'   \code{"adjacency"}.
+//' @param threads integer number of threads used to write the cells.
+//' @return The cells of the points \code{ids} in the format of
+//'   \code{voronoi()}. The neighbours of the adjacency are indices of all the
+//'   points of the diagram, and the areas of its faces are measured on the
+//'   stored polygons. Points deleted by \code{diagram_delete()} have no
+//'   cell.
+//' @export
+// [[Rcpp::export]]
+SEXP diagram_cells( SEXP diagram,
+                    Rcpp::Nullable< Rcpp::IntegerVector > ids = R_NilValue,
+                    std::string output = "wkt",
+                    bool polygons = false,
+                    int precision = 6,
+                    int threads = 1 )
+{
+  Diagram& cells = diagramHandle( diagram );
+  std::vector< size_t > selected;
+
+  if ( ids.isNull() )
+  {
+    for ( size_t id = 0; id < cells.size(); id++ )
+      selected.push_back( id );
+  }
+
+  else
+  {
+    Rcpp::IntegerVector indices ( ids );
+    for ( int index : indices )
     {
-      if ( con.compute_cell( vc, clo ) )
-      {
+      if ( index == NA_INTEGER || index < 1 || size_t( index ) > cells.size() )
+        Rcpp::stop( "Invalid ids: Values must be indices of the points." );
+      selected.push_back( index - 1 );
+    }
+  }
 
-        // Store the coordinates of the particle
-        clo.pos( i, j, k );
-
-        // Store coordinates of each vertex. Each set of vertex coordinates is
-        // stored at every 3 elements in `vertices`
-        vc.vertices( i, j, k, vertices );
-
-        long unsigned int vCounter = 0;
-        for ( ; vCounter < vertices.size(); vCounter += 3 )
-        {
-          point = DirVector( vertices[vCounter],
-                             vertices[vCounter + 1],
-                             vertices[vCounter + 2] );
-          points.push_back( point );
-        }
-
-        polyhedralsurface = "POLYHEDRALSURFACE(";
-
-        // Append unique face data to polyhedral surface. Each face has 3
-        // vertices and the data for each face indicates the indices of the 3
-        // vertices. The control flow below is copied from voro++ since the API
-        // is hard to understand.
-        for ( ii = 1; ii < vc.p; ii++ )
-        {
-          for ( jj = 0; jj < vc.nu[ii]; jj++ )
-          {
-            kk = vc.ed[ii][jj];
-            if ( kk >= 0 )
-            {
-              vc.ed[ii][jj] = -1 - kk;
-              ll = vc.cycle_up( vc.ed[ii][vc.nu[ii] + jj], kk );
-              mm = vc.ed[kk][ll];
-              vc.ed[kk][ll] = -1 - mm;
-              while ( mm != ii )
-              {
-                nn = vc.cycle_up( vc.ed[kk][vc.nu[kk] + ll], mm );
-
-                vO = DirVector( i, j, k ) - points[ii];
-                vA = points[kk] - points[ii];
-                vB = points[mm] - points[ii];
-                vC = vA * vB;
-
-                if ( angle_between( vO, vC ) > M_PI_2 )
-                {
-                  polygon = "((" +
-                    points[ii].point() + ", " +
-                    points[kk].point() + ", " +
-                    points[mm].point() + ", " +
-                    points[ii].point() + "))";
-                }
-
-                else
-                {
-                  polygon = "((" +
-                    points[ii].point() + ", " +
-                    points[mm].point() + ", " +
-                    points[kk].point() + ", " +
-                    points[ii].point() + "))";
-                }
-
-                if ( polyhedralsurface == "POLYHEDRALSURFACE(" )
-                  polyhedralsurface += polygon;
-                else
-                  polyhedralsurface += ", " + polygon;
-
-                kk = mm;
-                ll = nn;
-                mm = vc.ed[kk][ll];
-                vc.ed[kk][ll] = -1 - mm;
-              }
-            }
-          }
-        }
-
-        polyhedralsurface += ")";
-        cellGeometry[cGCount] = polyhedralsurface;
-        points.clear();
-      }
+  CellOutput written;
+  cells.write( selected, outputFormat( output ), polygons, precision, threads, written );
+  return outputObject( written );
+}
 
-      else
-        cellGeometry[cGCount] = NA_STRING;
+//' Locate Points in a Voronoi Diagram
+//'
+//' Find the cell of a diagram computed by \code{voronoi_diagram()} that holds
+//'   each query point, as \code{voronoi_locate()} does. Queries within the
+//'   container of the diagram are located in the container it holds.
+//'
+//' With \code{anisotropy}, the queries are located in the space where the
+//'   anisotropy ellipsoid is a sphere of the major range, so that they fall in
+//'   the anisotropic cells, and distances are measured in that space. Power
+//'   diagrams, computed with \code{radius}, cannot locate queries.
+//'
+//' @inheritParams voronoi_locate
+//' @inheritParams diagram_cells
+//' @param threads integer number of threads used to locate the queries.
+//' @return data frame as for \code{voronoi_locate()}.
+//' @export
+// [[Rcpp::export]]
+Rcpp::DataFrame diagram_locate( SEXP diagram,
+                                Rcpp::NumericVector qx,
+                                Rcpp::NumericVector qy,
+                                Rcpp::NumericVector qz,
+                                int threads = 1 )
+{
+  Diagram& cells = diagramHandle( diagram );
+  Points queries = checkPoints( qx, qy, qz );
+  std::vector< int > located;
+  std::vector< double > distances;
 
-      cGCount++;
+  cells.locate( queries, threads, located, distances );
+  return locateFrame( located, distances );
+}
+
+//' Insert Points in a Voronoi Diagram
+//'
+//' Insert points in a diagram computed by \code{voronoi_diagram()} and
+//'   compute again only the cells they change, instead of all cells. The
+//'   cells that change are found from the cell holding each point through the
+//'   neighbours of its faces, and are computed with the points within reach
+//'   of them. The container of the cells stays that of the points the diagram
+//'   was built from, so the cells are those of \code{voronoi()} on all points
+//'   as long as the inserted points do not widen the bounding box of the
+//'   points. In power diagrams, a point hidden by larger radii gets no cell.
+//'
+//' @inheritParams diagram_cells
+//' @param x,y,z numeric vectors of the coordinates of the inserted points,
+//'   which must lie within the container of the diagram. Their indices
+//'   follow those of the points of the diagram.
+//' @param radius \code{NULL}, or the radius of each inserted point, which
+//'   must be given if and only if the diagram is a power diagram.
+//' @param threads integer number of threads used to compute the cells.
+//' @return integer vector of the indices of the points whose cells changed,
+//'   including the inserted points, in increasing order.
+//' @export
+// [[Rcpp::export]]
+Rcpp::IntegerVector diagram_insert( SEXP diagram,
+                                    Rcpp::NumericVector x,
+                                    Rcpp::NumericVector y,
+                                    Rcpp::NumericVector z,
+                                    Rcpp::Nullable< Rcpp::NumericVector > radius = R_NilValue,
+                                    int threads = 1 )
+{
+  Diagram& cells = diagramHandle( diagram );
+  Points points = checkPoints( x, y, z );
+  pointRadii( points, radius );
+  std::vector< size_t > changed;
+
+  if ( cells.size() + points.n > size_t( INT_MAX ) )
+    Rcpp::stop( "Invalid points: The diagram would hold too many points." );
+
+  cells.insert( points, threads, changed );
+  return changedIds( changed );
+}
 
-    } while ( clo.inc() );
+//' Delete Points from a Voronoi Diagram
+//'
+//' Delete points from a diagram computed by \code{voronoi_diagram()} and
+//'   compute again only the cells of their neighbours, which are the only
+//'   cells that change, as \code{diagram_insert()} does. In power diagrams,
+//'   points whose cells were empty, hidden by points with larger radii, are
+//'   computed again as well where the deleted cells may uncover them. The
+//'   other points keep their indices and the deleted points keep theirs
+//'   without a cell.
+//'
+//' @inheritParams diagram_insert
+//' @param ids integer vector of the indices of the deleted points.
+//' @return integer vector of the indices of the points whose cells changed,
+//'   including the deleted points, in increasing order.
+//' @export
+// [[Rcpp::export]]
+Rcpp::IntegerVector diagram_delete( SEXP diagram,
+                                    Rcpp::IntegerVector ids,
+                                    int threads = 1 )
+{
+  Diagram& cells = diagramHandle( diagram );
+  std::vector< size_t > removed, changed;
+
+  for ( int index : ids )
+  {
+    if ( index == NA_INTEGER || index < 1 || size_t( index ) > cells.size() )
+      Rcpp::stop( "Invalid ids: Values must be indices of points that are not deleted." );
+    removed.push_back( index - 1 );
   }
 
-  return cellGeometry;
+  cells.remove( removed, threads, changed );
+  return changedIds( changed );
+}
+
+//' Summarize a Voronoi Diagram
+//'
+//' @inheritParams diagram_cells
+//' @return list with \code{points}, the number of points, \code{deleted},
+//'   the number of them deleted by \code{diagram_delete()}, \code{cells},
+//'   the number of cells that could be computed, \code{faces}, the number of
+//'   faces of all cells, \code{volume}, the volume of all cells, and
+//'   \code{bytes}, the approximate memory held by the diagram.
+//' @export
+// [[Rcpp::export]]
+Rcpp::List diagram_info( SEXP diagram )
+{
+  Diagram& cells = diagramHandle( diagram );
+  double computed = 0, faces = 0, volume = 0, deleted = 0;
+
+  for ( size_t id = 0; id < cells.size(); id++ )
+  {
+    deleted += cells.deleted( id );
+    if ( !cells.computed( id ) )
+      continue;
+
+    computed++;
+    faces += cells.faces( id );
+    volume += cells.volume( id );
+  }
+
+  return Rcpp::List::create( Rcpp::Named( "points" ) = double( cells.size() ),
+                             Rcpp::Named( "deleted" ) = deleted,
+                             Rcpp::Named( "cells" ) = computed,
+                             Rcpp::Named( "faces" ) = faces,
+                             Rcpp::Named( "volume" ) = volume,
+                             Rcpp::Named( "bytes" ) = double( cells.bytes() ) );
 }
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <math.h>
+#include <stdexcept>
+#include "walls.h"
+
+void addPrism( const double* x, const double* y, size_t n,
+               double zMin, double zMax, Walls& walls )
+{
+  if ( n > 1 && x[n - 1] == x[0] && y[n - 1] == y[0] )
+    n--;
+
+  if ( n < 3 )
+    throw std::invalid_argument( "Invalid prism: Polygon must have at least 3 vertices." );
+
+  if ( !( zMin < zMax ) )
+    throw std::invalid_argument( "Invalid prism: Lower z must be less than upper z." );
+
+  // Orientation of the polygon from its signed area
+  double area = 0, scale = 0;
+  for ( size_t i = 0; i < n; i++ )
+  {
+    size_t next = ( i + 1 ) % n;
+    area += x[i] * y[next] - x[next] * y[i];
+    scale = std::max( scale, std::max( fabs( x[i] ), fabs( y[i] ) ) );
+  }
+
+  if ( !isfinite( area ) || area == 0 )
+    throw std::invalid_argument( "Invalid prism: Polygon must have a positive area." );
+
+  double orientation = area > 0 ? 1 : -1;
+  double tolerance = 1e-9 * std::max( scale, 1.0 );
+
+  // One plane through each edge with the normal pointing out of the polygon.
+  // The polygon is convex if every vertex is inside of every edge.
+  for ( size_t i = 0; i < n; i++ )
+  {
+    size_t next = ( i + 1 ) % n;
+    double a = orientation * ( y[next] - y[i] );
+    double b = orientation * ( x[i] - x[next] );
+    double length = sqrt( a * a + b * b );
+    if ( length == 0 )
+      continue;
+
+    PlaneWall plane { a / length, b / length, 0, 0 };
+    plane.d = plane.a * x[i] + plane.b * y[i];
+
+    for ( size_t j = 0; j < n; j++ )
+    {
+      if ( plane.a * x[j] + plane.b * y[j] > plane.d + tolerance )
+        throw std::invalid_argument( "Invalid prism: Polygon must be convex." );
+    }
+
+    walls.planes.push_back( plane );
+  }
+
+  walls.planes.push_back( PlaneWall { 0, 0, 1, zMax } );
+  walls.planes.push_back( PlaneWall { 0, 0, -1, -zMin } );
+}
+
+void checkWalls( const Walls& walls )
+{
+  for ( const PlaneWall& plane : walls.planes )
+  {
+    double length = sqrt( plane.a * plane.a + plane.b * plane.b + plane.c * plane.c );
+    if ( !( length > 0 ) || !isfinite( length ) || !isfinite( plane.d ) )
+      throw std::invalid_argument( "Invalid planes: Each plane must have a finite non-zero normal and offset." );
+  }
+
+  for ( const CylinderWall& cylinder : walls.cylinders )
+  {
+    double length = sqrt( cylinder.dx * cylinder.dx + cylinder.dy * cylinder.dy
+                          + cylinder.dz * cylinder.dz );
+    bool finite = isfinite( cylinder.x ) && isfinite( cylinder.y ) &&
+      isfinite( cylinder.z ) && isfinite( length ) && isfinite( cylinder.radius );
+    if ( !finite || !( length > 0 ) || !( cylinder.radius > 0 ) )
+      throw std::invalid_argument( "Invalid cylinders: Each cylinder must have a finite axis and a positive radius." );
+  }
+}
+
+ContainerWalls::ContainerWalls( const Walls& walls )
+{
+  size_t index = 0;
+
+  // Unit normals keep the cuts of voro++ within its tolerances
+  for ( const PlaneWall& plane : walls.planes )
+  {
+    double length = sqrt( plane.a * plane.a + plane.b * plane.b + plane.c * plane.c );
+    this->walls.emplace_back(
+      new voro::wall_plane( plane.a / length, plane.b / length, plane.c / length,
+                            plane.d / length, wallId( index++ ) ) );
+  }
+
+  for ( const CylinderWall& cylinder : walls.cylinders )
+  {
+    this->walls.emplace_back(
+      new voro::wall_cylinder( cylinder.x, cylinder.y, cylinder.z,
+                               cylinder.dx, cylinder.dy, cylinder.dz,
+                               cylinder.radius, wallId( index++ ) ) );
+  }
+}
+
+void ContainerWalls::addTo( voro::container_base& con )
+{
+  for ( const std::unique_ptr< voro::wall >& wall : walls )
+    con.add_wall( *wall );
+}
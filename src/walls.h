@@ -0,0 +1,61 @@
+#ifndef WALLS_H
+#define WALLS_H
+
+#include <memory>
+#include <stddef.h>
+#include <vector>
+#include <voro++.hh>
+
+// Half-space a x + b y + c z <= d
+struct PlaneWall
+{
+  double a, b, c, d;
+};
+
+// Inside of the cylinder of `radius` around the axis through (x, y, z) with
+// direction (dx, dy, dz)
+struct CylinderWall
+{
+  double x, y, z, dx, dy, dz, radius;
+};
+
+// Walls bounding the cells in addition to the container. A cell is the part
+// of the voronoi cell of its point inside all walls.
+struct Walls
+{
+  std::vector< PlaneWall > planes;
+  std::vector< CylinderWall > cylinders;
+
+  bool empty() const { return planes.empty() && cylinders.empty(); }
+};
+
+// Neighbour id of the faces cut by the wall at `index` of `Walls`, counting the
+// planes before the cylinders. voro++ uses -1 to -6 for the container sides.
+inline int wallId( size_t index ) { return -7 - int( index ); }
+
+// Add the planes of the convex prism between `zMin` and `zMax` whose cross
+// section is the polygon with the `n` vertices (x, y), given in either
+// orientation. A closing vertex equal to the first one is ignored.
+void addPrism( const double* x, const double* y, size_t n,
+               double zMin, double zMax, Walls& walls );
+
+// Check that the planes have a normal and the cylinders an axis and a radius
+void checkWalls( const Walls& walls );
+
+// voro++ walls of `Walls`. The walls are applied when a cell is initialized,
+// before its neighbours are searched, so the search stops at the walls. A
+// cylinder cuts each cell by the plane tangent to the cylinder nearest to the
+// point of the cell, as the curved walls of voro++ do. The object must outlive
+// the containers it is added to.
+class ContainerWalls
+{
+public:
+  explicit ContainerWalls( const Walls& walls );
+
+  void addTo( voro::container_base& con );
+
+private:
+  std::vector< std::unique_ptr< voro::wall > > walls;
+};
+
+#endif
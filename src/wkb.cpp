@@ -0,0 +1,64 @@
+#include <stdint.h>
+#include <string.h>
+#include "wkb.h"
+
+// ISO geometry type codes of the Z variants
+static const uint32_t wkbPolygonZ = 1003;
+static const uint32_t wkbPolyhedralSurfaceZ = 1015;
+
+// Byte order flag of the machine: 1 for little endian (NDR), 0 for big endian
+// (XDR)
+static unsigned char byteOrder()
+{
+  const uint16_t one = 1;
+  unsigned char first;
+  memcpy( &first, &one, 1 );
+  return first;
+}
+
+static void putUInt32( unsigned char*& out, uint32_t value )
+{
+  memcpy( out, &value, 4 );
+  out += 4;
+}
+
+static void putVertex( unsigned char*& out, const double* vertex )
+{
+  memcpy( out, vertex, 24 );
+  out += 24;
+}
+
+void cellWkb( const CellMesh& mesh,
+              bool polygons,
+              FaceList& faces,
+              std::vector< unsigned char >& wkb )
+{
+  const unsigned char order = byteOrder();
+  const double* vertices = mesh.vertices.data();
+
+  mesh.orientedFaces( polygons, faces );
+  uint32_t count = faces.faces();
+
+  // Header of the surface, then per face a polygon header, the ring size and
+  // the vertices of the closed ring
+  wkb.resize( 9 + count * ( 9 + 4 + 24 ) + faces.vertices.size() * 24 );
+  unsigned char* out = wkb.data();
+
+  *out++ = order;
+  putUInt32( out, wkbPolyhedralSurfaceZ );
+  putUInt32( out, count );
+
+  for ( uint32_t f = 0; f < count; f++ )
+  {
+    const int* ring = faces.vertices.data() + faces.offsets[f];
+    uint32_t size = faces.offsets[f + 1] - faces.offsets[f];
+
+    *out++ = order;
+    putUInt32( out, wkbPolygonZ );
+    putUInt32( out, 1 );
+    putUInt32( out, size + 1 );
+    for ( uint32_t r = 0; r < size; r++ )
+      putVertex( out, vertices + 3 * ring[r] );
+    putVertex( out, vertices + 3 * ring[0] );
+  }
+}
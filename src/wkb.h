@@ -0,0 +1,16 @@
+#ifndef WKB_H
+#define WKB_H
+
+#include <vector>
+#include "cellMesh.h"
+
+// Polyhedral surface of a cell in ISO well-known binary with Z coordinates,
+// written in the byte order of the machine. The faces are written in the same
+// order and orientation as the well-known text: as polygons, or as fans of
+// triangles if `polygons` is false. `faces` is used as scratch space.
+void cellWkb( const CellMesh& mesh,
+              bool polygons,
+              FaceList& faces,
+              std::vector< unsigned char >& wkb );
+
+#endif
@@ -0,0 +1,59 @@
+#include "wkt.h"
+
+void WktWriter::write( const CellMesh& mesh, bool polygons, std::string& wkt )
+{
+  int f, r, size, vertexCount = mesh.vertices.size() / 3;
+  const int* ring;
+
+  points.clear();
+  pointOffsets.clear();
+  pointOffsets.push_back( 0 );
+  for ( int v = 0; v < vertexCount; v++ )
+  {
+    format.append( points, mesh.vertices[3 * v] );
+    points += ' ';
+    format.append( points, mesh.vertices[3 * v + 1] );
+    points += ' ';
+    format.append( points, mesh.vertices[3 * v + 2] );
+    pointOffsets.push_back( points.size() );
+  }
+
+  mesh.orientedFaces( polygons, faces );
+
+  // Each ring is closed by repeating its first vertex, so a ring of `size`
+  // vertices takes `size + 1` points and separators
+  size_t length = 20;
+  for ( f = 0; f < faces.faces(); f++ )
+  {
+    ring = faces.vertices.data() + faces.offsets[f];
+    size = faces.offsets[f + 1] - faces.offsets[f];
+    length += 6 + 2 * size;
+    for ( r = 0; r < size; r++ )
+      length += pointOffsets[ring[r] + 1] - pointOffsets[ring[r]];
+    length += pointOffsets[ring[0] + 1] - pointOffsets[ring[0]];
+  }
+
+  wkt.clear();
+  wkt.reserve( length );
+  wkt += "POLYHEDRALSURFACE(";
+
+  for ( f = 0; f < faces.faces(); f++ )
+  {
+    ring = faces.vertices.data() + faces.offsets[f];
+    size = faces.offsets[f + 1] - faces.offsets[f];
+
+    if ( f > 0 )
+      wkt += ", ";
+    wkt += "((";
+    for ( r = 0; r <= size; r++ )
+    {
+      int v = ring[r % size];
+      if ( r > 0 )
+        wkt += ", ";
+      wkt.append( points, pointOffsets[v], pointOffsets[v + 1] - pointOffsets[v] );
+    }
+    wkt += "))";
+  }
+
+  wkt += ")";
+}
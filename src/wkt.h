@@ -0,0 +1,48 @@
+#ifndef WKT_H
+#define WKT_H
+
+#include <string>
+#include <vector>
+#include "cellMesh.h"
+#include "numberFormat.h"
+
+// Writes cells as polyhedral surfaces in well-known text. The coordinates of
+// each vertex are formatted once per cell into a buffer that is reused from
+// cell to cell, then copied into every face that uses the vertex. A writer
+// holds scratch space, so each thread needs its own.
+class WktWriter
+{
+public:
+
+  explicit WktWriter( NumberFormat format = NumberFormat() ) :
+    format( format ) {}
+
+  // Replace `wkt` with the polyhedral surface of `mesh`. Each face is written
+  // as one polygon, or as a fan of triangles if `polygons` is false.
+  void write( const CellMesh& mesh, bool polygons, std::string& wkt );
+
+  // Well-known text of a cell that could not be computed, of the same
+  // geometry type as the cells written by `write()`
+  static const char* empty() { return "POLYHEDRALSURFACE EMPTY"; }
+
+  // Bytes of scratch space held by the writer
+  size_t scratchBytes() const
+  {
+    return points.capacity()
+      + pointOffsets.capacity() * sizeof( size_t )
+      + faces.bytes();
+  }
+
+private:
+
+  NumberFormat format;
+  FaceList faces;
+
+  // Space delimited coordinates of each vertex of the current cell. Vertex
+  // `v` is stored from `pointOffsets[v]` up to `pointOffsets[v + 1]`.
+  std::string points;
+  std::vector< size_t > pointOffsets;
+
+};
+
+#endif
@@ -0,0 +1,211 @@
+#include <algorithm>
+#include <math.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include <Rcpp.h>
+#include <R_ext/Altrep.h>
+
+#include "lazyWkt.h"
+#include "wktVector.h"
+
+// Elements of a lazy WKT vector: the cells of the points `ids`, or of all
+// points if `ids` is empty. The first element of the vector is `data1`, an
+// external pointer to these elements, and the second is `data2`, the
+// character vector once it is written, or NULL.
+struct WktElements
+{
+  std::shared_ptr< LazyWkt > cells;
+  std::vector< size_t > ids;
+  R_xlen_t length = 0;
+  int threads = 1;
+  std::string text;
+
+  size_t id( R_xlen_t i ) const { return ids.empty() ? size_t( i ) : ids[i]; }
+};
+
+// Number of elements written at once when a whole vector is written, which
+// bounds the text held besides the vector
+static const R_xlen_t WRITE_BATCH = 4096;
+
+static R_altrep_class_t wktClass;
+
+static WktElements& wktElements( SEXP x )
+{
+  return *static_cast< WktElements* >( R_ExternalPtrAddr( R_altrep_data1( x ) ) );
+}
+
+static SEXP newWktVector( std::unique_ptr< WktElements > elements )
+{
+  SEXP pointer = PROTECT( R_MakeExternalPtr( elements.get(), R_NilValue, R_NilValue ) );
+  R_RegisterCFinalizerEx( pointer, []( SEXP pointer )
+  {
+    delete static_cast< WktElements* >( R_ExternalPtrAddr( pointer ) );
+    R_ClearExternalPtr( pointer );
+  }, TRUE );
+
+  SEXP vector = R_new_altrep( wktClass, pointer, R_NilValue );
+  elements.release();
+  UNPROTECT( 1 );
+  return vector;
+}
+
+// Write all elements of `x` into `data2` and release the cells
+static SEXP writeWktVector( SEXP x )
+{
+  SEXP written = R_altrep_data2( x );
+  if ( written != R_NilValue )
+    return written;
+
+  WktElements& elements = wktElements( x );
+  written = PROTECT( Rf_allocVector( STRSXP, elements.length ) );
+  std::vector< size_t > ids;
+  std::vector< std::string > texts;
+
+  for ( R_xlen_t first = 0; first < elements.length; first += WRITE_BATCH )
+  {
+    R_xlen_t last = std::min( first + WRITE_BATCH, elements.length );
+    ids.clear();
+    for ( R_xlen_t i = first; i < last; i++ )
+      ids.push_back( elements.id( i ) );
+
+    elements.cells->write( ids, elements.threads, texts );
+    for ( R_xlen_t i = first; i < last; i++ )
+    {
+      const std::string& text = texts[i - first];
+      SET_STRING_ELT( written, i, elements.cells->computed( ids[i - first] )
+                      ? Rf_mkCharLen( text.data(), int( text.size() ) )
+                      : NA_STRING );
+    }
+  }
+
+  R_set_altrep_data2( x, written );
+  elements.cells.reset();
+  std::vector< size_t >().swap( elements.ids );
+  UNPROTECT( 1 );
+  return written;
+}
+
+static R_xlen_t wktLength( SEXP x )
+{
+  return wktElements( x ).length;
+}
+
+static Rboolean wktInspect( SEXP x, int, int, int, void ( * )( SEXP, int, int, int ) )
+{
+  Rprintf( " voro3d wkt (%s)\n", R_altrep_data2( x ) == R_NilValue ? "lazy" : "written" );
+  return TRUE;
+}
+
+static SEXP wktElt( SEXP x, R_xlen_t i )
+{
+  SEXP written = R_altrep_data2( x );
+  if ( written != R_NilValue )
+    return STRING_ELT( written, i );
+
+  WktElements& elements = wktElements( x );
+  size_t id = elements.id( i );
+  if ( !elements.cells->computed( id ) )
+    return NA_STRING;
+
+  elements.cells->write( id, elements.text );
+  return Rf_mkCharLen( elements.text.data(), int( elements.text.size() ) );
+}
+
+static void wktSetElt( SEXP x, R_xlen_t i, SEXP value )
+{
+  SET_STRING_ELT( writeWktVector( x ), i, value );
+}
+
+static int wktNoNA( SEXP x )
+{
+  if ( R_altrep_data2( x ) != R_NilValue )
+    return 0;
+
+  const WktElements& elements = wktElements( x );
+  for ( R_xlen_t i = 0; i < elements.length; i++ )
+  {
+    if ( !elements.cells->computed( elements.id( i ) ) )
+      return 0;
+  }
+
+  return 1;
+}
+
+static void* wktDataptr( SEXP x, Rboolean )
+{
+  return DATAPTR( writeWktVector( x ) );
+}
+
+static const void* wktDataptrOrNull( SEXP x )
+{
+  SEXP written = R_altrep_data2( x );
+  return written == R_NilValue ? nullptr : DATAPTR_RO( written );
+}
+
+// Vector of the elements `indices` of `x`, sharing its cells. NULL, for the
+// default subsetting of R, if `x` is written or an index is NA or out of
+// range.
+static SEXP wktExtractSubset( SEXP x, SEXP indices, SEXP )
+{
+  if ( R_altrep_data2( x ) != R_NilValue
+       || ( TYPEOF( indices ) != INTSXP && TYPEOF( indices ) != REALSXP ) )
+    return nullptr;
+
+  const WktElements& elements = wktElements( x );
+  R_xlen_t n = Rf_xlength( indices );
+  std::unique_ptr< WktElements > subset ( new WktElements() );
+  subset->cells = elements.cells;
+  subset->length = n;
+  subset->threads = elements.threads;
+  subset->ids.reserve( n );
+
+  for ( R_xlen_t i = 0; i < n; i++ )
+  {
+    double index = TYPEOF( indices ) == INTSXP
+      ? ( INTEGER_ELT( indices, i ) == NA_INTEGER ? NAN : INTEGER_ELT( indices, i ) )
+      : REAL_ELT( indices, i );
+
+    if ( !( index >= 1 && index <= double( elements.length ) ) )
+      return nullptr;
+
+    subset->ids.push_back( elements.id( R_xlen_t( index ) - 1 ) );
+  }
+
+  return newWktVector( std::move( subset ) );
+}
+
+// Copy of `x` sharing its cells, unless it is written
+static SEXP wktDuplicate( SEXP x, Rboolean )
+{
+  if ( R_altrep_data2( x ) != R_NilValue )
+    return nullptr;
+
+  std::unique_ptr< WktElements > copy ( new WktElements( wktElements( x ) ) );
+  copy->text.clear();
+  return newWktVector( std::move( copy ) );
+}
+
+SEXP wktVector( CellOutput& cells, bool polygons, int precision, int threads )
+{
+  std::unique_ptr< WktElements > elements ( new WktElements() );
+  elements->cells.reset( new LazyWkt( std::move( cells ), polygons, precision ) );
+  elements->length = elements->cells->size();
+  elements->threads = threads;
+  return newWktVector( std::move( elements ) );
+}
+
+// [[Rcpp::init]]
+void registerWktVector( DllInfo* dll )
+{
+  wktClass = R_make_altstring_class( "wkt", "voro3d", dll );
+  R_set_altrep_Length_method( wktClass, wktLength );
+  R_set_altrep_Inspect_method( wktClass, wktInspect );
+  R_set_altrep_Duplicate_method( wktClass, wktDuplicate );
+  R_set_altvec_Dataptr_method( wktClass, wktDataptr );
+  R_set_altvec_Dataptr_or_null_method( wktClass, wktDataptrOrNull );
+  R_set_altvec_Extract_subset_method( wktClass, wktExtractSubset );
+  R_set_altstring_Elt_method( wktClass, wktElt );
+  R_set_altstring_Set_elt_method( wktClass, wktSetElt );
+  R_set_altstring_No_NA_method( wktClass, wktNoNA );
+}
@@ -0,0 +1,16 @@
+#ifndef WKT_VECTOR_H
+#define WKT_VECTOR_H
+
+#include <Rcpp.h>
+#include "engine.h"
+
+// Character vector of the well-known text of `cells`, computed with
+// `CellOptions::deferText`. The vector is an ALTREP object that keeps the
+// walked meshes of the cells and writes the text of an element only when it
+// is read: the length, subsets, duplicates and `anyNA()` never write text,
+// and a subset shares the meshes of the vector it was taken from. Functions
+// that need the whole vector in memory get all its elements written at once
+// on `threads` threads, after which the meshes are released.
+SEXP wktVector( CellOutput& cells, bool polygons, int precision, int threads );
+
+#endif